@@ -0,0 +1,282 @@
+#ifndef ARA_STAR_H
+#define ARA_STAR_H
+
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "search_state.h"
+#include "open_list.h"
+#include "neighborhoods.h"
+#include "lazy_array.h"
+
+// Anytime Repairing A* (ARA*) for callers with a fixed time budget. The
+// first search orders by g + w * h with a large weight w and finds a path
+// quickly; each later search lowers w and continues from the previous one
+// instead of starting over: cells improved after they were expanded are
+// kept aside (INCONS) and seeded into the next search, so only the part of
+// the tree that changes is searched again.
+//
+// Every published path carries a bound: its cost is at most bound times
+// the optimal cost, provided the heuristic is admissible (Octile or
+// Chebyshev for eight-connected moves). A bound of 1 means optimal.
+//
+// begin() prepares a query and improve() searches until the path is
+// optimal, the deadline passes or the expansion budget is used up, so a
+// control loop can call improve() once per tick and keep the best path so
+// far. The deadline is checked every few dozen expansions; re-ordering the
+// open list between searches is not interruptible.
+template <class HeuristicT = Heuristic, class Neighborhood = EightConnected, class MapT = Grid>
+class BasicAnytimeAStar {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Solution {
+        double cost;
+        double bound;       // cost <= bound * optimal cost
+        double weight;      // heuristic weight of the search that found it
+        long long elapsed_ns; // since begin()
+        long long expanded;   // expansions since begin()
+    };
+
+private:
+    static const int DEADLINE_CHECK_INTERVAL = 64;
+
+    const MapT& grid;
+    HeuristicT heuristic;
+    double initial_weight;
+    double weight_step;
+
+    SearchState state;
+    QuaternaryHeapOpenList open_list;
+    // A cell is closed, or listed in INCONS, when its stamp holds the
+    // number of the current search
+    LazyArray<uint32_t> closed_stamps;
+    LazyArray<uint32_t> incons_stamps;
+    uint32_t iteration;
+    std::vector<int> incons;
+    std::vector<int> reorder;
+
+    Cell goal;
+    int goal_key;
+    double weight;
+    bool finished;
+    std::vector<Cell> path;
+    double path_cost;
+    double bound;
+    std::vector<Solution> solutions;
+    long long nodes_expanded;
+    Clock::time_point began;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    double estimate(int key) {
+        return heuristic(keyToCell(key), goal);
+    }
+
+    void nextIteration() {
+        if (++iteration == 0) {
+            closed_stamps.clear();
+            incons_stamps.clear();
+            iteration = 1;
+        }
+    }
+
+    // One weighted search, until no open cell can beat the goal. False if
+    // it ran out of budget first; the open list is kept, so the next call
+    // carries on where this one stopped.
+    bool improvePath(Clock::time_point deadline, long long node_budget, long long& expanded) {
+        Cell neighbors[Neighborhood::MAX_NEIGHBORS];
+        double costs[Neighborhood::MAX_NEIGHBORS];
+        while (!open_list.empty()) {
+            double goal_g = state.status(goal_key) == SearchState::UNSEEN ? std::numeric_limits<double>::infinity()
+                                                                           : state.g(goal_key);
+            if (goal_g <= open_list.topPriority()) return true;
+            if (node_budget >= 0 && expanded >= node_budget) return false;
+            if (expanded % DEADLINE_CHECK_INTERVAL == 0 && Clock::now() >= deadline) return false;
+
+            int current_key = open_list.pop();
+            closed_stamps[current_key] = iteration;
+            expanded++;
+            nodes_expanded++;
+
+            Cell current = keyToCell(current_key);
+            double current_g = state.g(current_key);
+            int count = Neighborhood::expand(grid, current, neighbors, costs);
+            for (int i = 0; i < count; ++i) {
+                int neighbor_key = cellToKey(neighbors[i]);
+                double new_g_cost = current_g + costs[i];
+                if (state.status(neighbor_key) != SearchState::UNSEEN && new_g_cost >= state.g(neighbor_key)) continue;
+                state.open(neighbor_key, new_g_cost, current_key);
+
+                if (closed_stamps[neighbor_key] == iteration) {
+                    if (incons_stamps[neighbor_key] != iteration) {
+                        incons_stamps[neighbor_key] = iteration;
+                        incons.push_back(neighbor_key);
+                    }
+                    continue;
+                }
+                double f_cost = new_g_cost + weight * estimate(neighbor_key);
+                if (open_list.contains(neighbor_key)) open_list.decrease(neighbor_key, f_cost);
+                else open_list.push(neighbor_key, f_cost);
+            }
+        }
+        return true;
+    }
+
+    // Records the path of a finished search and its bound, then prepares
+    // the next search with a lower weight
+    void publish() {
+        if (state.status(goal_key) == SearchState::UNSEEN) {
+            finished = true; // open list exhausted: no path
+            return;
+        }
+
+        path.clear();
+        for (int key = goal_key; key != -1; key = state.parent(key)) path.push_back(keyToCell(key));
+        std::reverse(path.begin(), path.end());
+        path_cost = state.g(goal_key);
+
+        // No cell left to expand can lead to a path cheaper than min(g + h)
+        double lower = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < open_list.size(); ++i) {
+            int key = open_list.keyAt(i);
+            lower = std::min(lower, state.g(key) + estimate(key));
+        }
+        for (size_t i = 0; i < incons.size(); ++i) lower = std::min(lower, state.g(incons[i]) + estimate(incons[i]));
+        bound = lower >= path_cost ? 1.0 : std::min(weight, path_cost / lower);
+
+        Solution solution;
+        solution.cost = path_cost;
+        solution.bound = bound;
+        solution.weight = weight;
+        solution.elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - began).count();
+        solution.expanded = nodes_expanded;
+        solutions.push_back(solution);
+
+        if (bound <= 1.0) {
+            finished = true;
+            return;
+        }
+
+        weight = std::max(1.0, std::min(weight - weight_step, bound));
+        nextIteration();
+        reorder.clear();
+        for (int i = 0; i < open_list.size(); ++i) reorder.push_back(open_list.keyAt(i));
+        for (size_t i = 0; i < reorder.size(); ++i) {
+            open_list.update(reorder[i], state.g(reorder[i]) + weight * estimate(reorder[i]));
+        }
+        for (size_t i = 0; i < incons.size(); ++i) {
+            open_list.push(incons[i], state.g(incons[i]) + weight * estimate(incons[i]));
+        }
+        incons.clear();
+    }
+
+public:
+    // Weights go from initial_weight down by weight_step (or straight to
+    // the proven bound when that is lower) until 1
+    BasicAnytimeAStar(const MapT& g, HeuristicT h = HeuristicT(), double initial_weight = 3.0, double weight_step = 0.5)
+        : grid(g), heuristic(h), initial_weight(initial_weight), weight_step(weight_step), iteration(0), goal_key(0),
+          weight(initial_weight), finished(true), path_cost(0), bound(std::numeric_limits<double>::infinity()),
+          nodes_expanded(0) {
+        goal.x = goal.y = 0;
+    }
+
+    void begin(const Cell& start, const Cell& target) {
+        int num_cells = grid.width * grid.height;
+        state.reset(num_cells);
+        open_list.reset(num_cells);
+        if (static_cast<int>(closed_stamps.size()) != num_cells) {
+            closed_stamps.allocate(num_cells);
+            incons_stamps.allocate(num_cells);
+            iteration = 0;
+        }
+        nextIteration();
+        incons.clear();
+        path.clear();
+        solutions.clear();
+
+        goal = target;
+        goal_key = cellToKey(goal);
+        weight = initial_weight;
+        finished = false;
+        path_cost = 0;
+        bound = std::numeric_limits<double>::infinity();
+        nodes_expanded = 0;
+        began = Clock::now();
+
+        int start_key = cellToKey(start);
+        state.open(start_key, 0, -1);
+        open_list.push(start_key, weight * estimate(start_key));
+    }
+
+    // Searches until the path is optimal, the deadline passes or
+    // node_budget expansions (negative: unlimited) were made in this call.
+    // True if some path is known.
+    bool improve(Clock::time_point deadline = Clock::time_point::max(), long long node_budget = -1) {
+        long long expanded = 0;
+        while (!finished && improvePath(deadline, node_budget, expanded)) publish();
+        return !path.empty();
+    }
+
+    // Optimal path with no budget
+    bool findPath(const Cell& start, const Cell& target) {
+        begin(start, target);
+        return improve();
+    }
+
+    bool findPath(const Cell& start, const Cell& target, std::chrono::nanoseconds time_budget,
+                  long long node_budget = -1) {
+        Clock::time_point deadline = Clock::now() + time_budget;
+        begin(start, target);
+        return improve(deadline, node_budget);
+    }
+
+    // Nothing left to improve: the path is optimal or there is none
+    bool isFinished() const {
+        return finished;
+    }
+
+    // Suboptimality bound of the current path, infinity before the first
+    double getBound() const {
+        return bound;
+    }
+
+    // Every path published since begin(), in order of discovery
+    const std::vector<Solution>& getSolutions() const {
+        return solutions;
+    }
+
+    int getPathLength() const {
+        return path.size();
+    }
+
+    double getPathCost() const {
+        return path_cost;
+    }
+
+    int getNodesExpanded() const {
+        return static_cast<int>(nodes_expanded);
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+};
+
+template <class HeuristicT, class Neighborhood, class MapT>
+const int BasicAnytimeAStar<HeuristicT, Neighborhood, MapT>::DEADLINE_CHECK_INTERVAL;
+
+typedef BasicAnytimeAStar<> AnytimeAStar;
+
+#endif
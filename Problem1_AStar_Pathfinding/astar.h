@@ -2,150 +2,191 @@
 #define ASTAR_H
 
 #include <vector>
-#include <queue>
-#include <unordered_map>
 #include <cmath>
 #include <algorithm>
 #include "grid_generator.h"
 #include "heuristics.h"
+#include "search_state.h"
+#include "open_list.h"
+#include "neighborhoods.h"
+#include "search_stats.h"
 
-struct Node {
-    Cell cell;
-    double g_cost;  // Cost from start to this node
-    double h_cost;  // Heuristic cost to goal
-    double f_cost() const { return g_cost + h_cost; }
-    Node* parent;
-    
-    Node(Cell c, double g, double h, Node* p = nullptr) 
-        : cell(c), g_cost(g), h_cost(h), parent(p) {}
-};
-
-struct NodeCompare {
-    bool operator()(const Node* a, const Node* b) const {
-        return a->f_cost() > b->f_cost();
-    }
-};
-
-class AStar {
+// All search memory (state arrays, open list, path) is kept between calls,
+// so once it has grown to the map size repeated queries allocate nothing.
+// OpenList is any implementation from open_list.h. The grid is referenced,
+// not copied, so it must outlive the solver; many solvers can share it.
+//
+// HeuristicT is a distance functor from heuristics.h and Neighborhood a
+// movement model from neighborhoods.h. MapT is Grid or another map with
+// the same start/goal/width/height/isObstacle interface, such as the
+// memory-mapped TiledMap. With concrete types both are
+// inlined into the search loop; the default Heuristic keeps the choice of
+// estimate at runtime, at the price of an indirect call per neighbor.
+template <class OpenList = QuaternaryHeapOpenList, class HeuristicT = Heuristic, class Neighborhood = EightConnected,
+          class MapT = Grid>
+class BasicAStar {
 private:
-    Grid grid;
-    HeuristicFunction heuristic;
-    std::vector<Node*> open_list;
-    std::unordered_map<int, Node*> all_nodes;
+    const MapT* grid;
+    HeuristicT heuristic;
+    SearchState state;
+    OpenList open_list;
     std::vector<Cell> path;
     int nodes_expanded;
-    
+#ifdef ASTAR_ENABLE_STATS
+    SearchStats stats;
+    HardwareCounters counters;
+#endif
+
     int cellToKey(const Cell& cell) const {
-        return cell.y * grid.width + cell.x;
+        return cell.y * grid->width + cell.x;
     }
-    
-    std::vector<Cell> getNeighbors(const Cell& cell) const {
-        std::vector<Cell> neighbors;
-        int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
-        int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
-        
-        for (int i = 0; i < 8; ++i) {
-            int new_x = cell.x + dx[i];
-            int new_y = cell.y + dy[i];
-            
-            if (grid.isValidCell(new_x, new_y) && !grid.isObstacle(new_x, new_y)) {
-                neighbors.push_back({new_x, new_y});
-            }
-        }
-        
-        return neighbors;
-    }
-    
-    double getMoveCost(const Cell& from, const Cell& to) const {
-        // Diagonal moves cost more
-        if (from.x != to.x && from.y != to.y) {
-            return 1.414; // sqrt(2)
-        }
-        return 1.0;
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid->width, key / grid->width};
+        return cell;
     }
-    
-    void reconstructPath(Node* node) {
+
+    void reconstructPath(int key) {
         path.clear();
-        while (node != nullptr) {
-            path.push_back(node->cell);
-            node = node->parent;
+        while (key != -1) {
+            path.push_back(keyToCell(key));
+            key = state.parent(key);
         }
         std::reverse(path.begin(), path.end());
     }
-    
-    void cleanup() {
-        for (auto& pair : all_nodes) {
-            delete pair.second;
-        }
-        all_nodes.clear();
-        open_list.clear();
-        path.clear();
-    }
 
-public:
-    AStar(const Grid& g, HeuristicFunction h) : grid(g), heuristic(h), nodes_expanded(0) {}
-    
-    ~AStar() {
-        cleanup();
-    }
-    
-    bool findPath() {
-        cleanup();
+    bool search(const Cell& start, const Cell& goal) {
+        state.reset(grid->width * grid->height);
+        open_list.reset(grid->width * grid->height);
+        path.clear();
         nodes_expanded = 0;
-        
-        Node* start_node = new Node(grid.start, 0, heuristic(grid.start, grid.goal));
-        all_nodes[cellToKey(grid.start)] = start_node;
-        open_list.push_back(start_node);
-        std::push_heap(open_list.begin(), open_list.end(), NodeCompare());
-        
+
+        int start_key = cellToKey(start);
+        state.open(start_key, 0, -1);
+        open_list.push(start_key, heuristic(start, goal));
+        ASTAR_STAT(stats.pushes++);
+
+        Cell neighbors[Neighborhood::MAX_NEIGHBORS];
+        double costs[Neighborhood::MAX_NEIGHBORS];
         while (!open_list.empty()) {
-            std::pop_heap(open_list.begin(), open_list.end(), NodeCompare());
-            Node* current = open_list.back();
-            open_list.pop_back();
-            
+            ASTAR_STAT(stats.noteOpenSize(open_list.size()));
+            int current_key;
+            {
+                ASTAR_STAT(PhaseTimer timer(stats.open_list_ns));
+                current_key = open_list.pop();
+            }
+            state.close(current_key);
+            ASTAR_STAT(stats.notePop());
+
             nodes_expanded++;
-            
-            if (current->cell.x == grid.goal.x && current->cell.y == grid.goal.y) {
-                reconstructPath(current);
+
+            Cell current = keyToCell(current_key);
+            if (current == goal) {
+                reconstructPath(current_key);
                 return true;
             }
-            
-            for (const Cell& neighbor_cell : getNeighbors(current->cell)) {
-                double new_g_cost = current->g_cost + getMoveCost(current->cell, neighbor_cell);
+
+            double current_g = state.g(current_key);
+            int count;
+            {
+                ASTAR_STAT(PhaseTimer timer(stats.neighbors_ns));
+                count = Neighborhood::expand(*grid, current, neighbors, costs);
+            }
+            ASTAR_STAT(stats.neighbors_generated += count);
+            ASTAR_STAT(stats.neighbors_blocked += Neighborhood::MAX_NEIGHBORS - count);
+            for (int i = 0; i < count; ++i) {
+                const Cell& neighbor_cell = neighbors[i];
+                double new_g_cost = current_g + costs[i];
                 int neighbor_key = cellToKey(neighbor_cell);
-                
-                if (all_nodes.find(neighbor_key) == all_nodes.end()) {
-                    Node* neighbor_node = new Node(neighbor_cell, new_g_cost, 
-                                                 heuristic(neighbor_cell, grid.goal), current);
-                    all_nodes[neighbor_key] = neighbor_node;
-                    open_list.push_back(neighbor_node);
-                    std::push_heap(open_list.begin(), open_list.end(), NodeCompare());
-                } else {
-                    Node* existing_node = all_nodes[neighbor_key];
-                    if (new_g_cost < existing_node->g_cost) {
-                        existing_node->g_cost = new_g_cost;
-                        existing_node->parent = current;
-                        // Re-heapify
-                        std::make_heap(open_list.begin(), open_list.end(), NodeCompare());
+                SearchState::Status status = state.status(neighbor_key);
+
+                if (status == SearchState::UNSEEN) {
+                    state.open(neighbor_key, new_g_cost, current_key);
+                    double f_cost = new_g_cost + heuristic(neighbor_cell, goal);
+                    ASTAR_STAT(PhaseTimer timer(stats.open_list_ns));
+                    ASTAR_STAT(stats.pushes++);
+                    open_list.push(neighbor_key, f_cost);
+                } else if (new_g_cost < state.g(neighbor_key)) {
+                    double f_cost = new_g_cost + heuristic(neighbor_cell, goal);
+                    state.open(neighbor_key, new_g_cost, current_key);
+                    ASTAR_STAT(PhaseTimer timer(stats.open_list_ns));
+                    if (status == SearchState::CLOSED) {
+                        // Inconsistent heuristics can close a node too early
+                        ASTAR_STAT(stats.reopenings++; stats.pushes++; stats.closed--);
+                        open_list.push(neighbor_key, f_cost);
+                    } else {
+                        ASTAR_STAT(stats.decrease_keys++);
+                        open_list.decrease(neighbor_key, f_cost);
                     }
+                } else {
+                    ASTAR_STAT(stats.neighbors_rejected++);
                 }
             }
         }
-        
+
         return false; // No path found
     }
-    
+
+public:
+    BasicAStar(const MapT& g, HeuristicT h = HeuristicT()) : grid(&g), heuristic(h), nodes_expanded(0) {}
+
+    // Searches another map of the same type from the next query on, keeping
+    // the search memory (e.g. a newer MapSnapshot)
+    void setMap(const MapT& g) {
+        grid = &g;
+    }
+
+    bool findPath() {
+        return findPath(grid->start, grid->goal);
+    }
+
+    bool findPath(const Cell& start, const Cell& goal) {
+#ifdef ASTAR_ENABLE_STATS
+        stats.reset();
+        bool counting = counters.isOpen();
+        if (counting) counters.start();
+        bool found;
+        {
+            PhaseTimer timer(stats.total_ns);
+            found = search(start, goal);
+        }
+        if (counting) stats.hardware_counters = counters.stop(stats.cycles, stats.instructions, stats.llc_misses);
+        return found;
+#else
+        return search(start, goal);
+#endif
+    }
+
     int getPathLength() const {
         return path.size();
     }
-    
+
+    double getPathCost() const {
+        return path.empty() ? 0 : state.g(cellToKey(path.back()));
+    }
+
     int getNodesExpanded() const {
         return nodes_expanded;
     }
-    
+
     const std::vector<Cell>& getPath() const {
         return path;
     }
+
+#ifdef ASTAR_ENABLE_STATS
+    // Counters of the last findPath()
+    const SearchStats& getStats() const {
+        return stats;
+    }
+
+    // Starts reading cycles, instructions and LLC misses on every query;
+    // false if the platform or the kernel does not allow it
+    bool enableHardwareCounters() {
+        return counters.open();
+    }
+#endif
 };
 
-#endif
\ No newline at end of file
+typedef BasicAStar<> AStar;
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef BATCH_PATHFINDER_H
+#define BATCH_PATHFINDER_H
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "astar.h"
+#include "thread_pool.h"
+
+struct PathQuery {
+    Cell start;
+    Cell goal;
+};
+
+// Paths of a batch packed end to end: query i owns
+// cells[offsets[i], offsets[i + 1]). Unsolvable queries have empty paths.
+struct PathBatchResult {
+    std::vector<Cell> cells;
+    std::vector<size_t> offsets;
+    std::vector<double> costs;
+    std::vector<char> found;
+
+    size_t size() const {
+        return costs.size();
+    }
+
+    const Cell* pathBegin(size_t query) const {
+        return cells.data() + offsets[query];
+    }
+
+    size_t pathLength(size_t query) const {
+        return offsets[query + 1] - offsets[query];
+    }
+};
+
+// Answers batches of queries against one shared, read-only grid on a
+// thread pool. Each worker keeps its own Solver (and so its own search
+// scratch) and path buffer across batches. Queries are dealt out as one
+// contiguous range per worker; a worker that runs dry steals chunks from
+// the others' ranges.
+template <class Solver = AStar>
+class BatchPathfinder {
+private:
+    static const size_t CHUNK = 16;
+
+    // Padded so that workers claiming from neighbouring ranges do not
+    // share a cache line
+    struct QueryRange {
+        std::atomic<size_t> next;
+        size_t end;
+        char padding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    };
+
+    struct Placement {
+        int worker;
+        size_t offset;
+        size_t length;
+    };
+
+    const Grid& grid;
+    ThreadPool pool;
+    std::vector<std::unique_ptr<Solver> > solvers;
+    std::vector<std::vector<Cell> > worker_cells;
+    std::unique_ptr<QueryRange[]> ranges;
+    std::vector<Placement> placements;
+
+    void solveRange(int worker, const PathQuery* queries, size_t begin, size_t end, PathBatchResult& result) {
+        Solver& solver = *solvers[worker];
+        std::vector<Cell>& local = worker_cells[worker];
+        for (size_t i = begin; i < end; ++i) {
+            bool found = solver.findPath(queries[i].start, queries[i].goal);
+            const std::vector<Cell>& path = solver.getPath();
+            Placement placement = {worker, local.size(), path.size()};
+            placements[i] = placement;
+            local.insert(local.end(), path.begin(), path.end());
+            result.found[i] = found;
+            result.costs[i] = found ? solver.getPathCost() : 0;
+        }
+    }
+
+    void work(int worker, const PathQuery* queries, PathBatchResult& result) {
+        int num_workers = pool.size();
+        worker_cells[worker].clear();
+        for (int i = 0; i < num_workers; ++i) {
+            QueryRange& range = ranges[(worker + i) % num_workers];
+            while (true) {
+                size_t begin = range.next.fetch_add(CHUNK);
+                if (begin >= range.end) break;
+                solveRange(worker, queries, begin, std::min(begin + CHUNK, range.end), result);
+            }
+        }
+    }
+
+public:
+    // num_threads <= 0 uses every hardware thread
+    BatchPathfinder(const Grid& g, Heuristic heuristic, int num_threads = 0)
+        : grid(g), pool(num_threads), worker_cells(pool.size()), ranges(new QueryRange[pool.size()]) {
+        for (int i = 0; i < pool.size(); ++i) {
+            solvers.push_back(std::unique_ptr<Solver>(new Solver(grid, heuristic)));
+        }
+    }
+
+    int threadCount() const {
+        return pool.size();
+    }
+
+    void solve(const PathQuery* queries, size_t count, PathBatchResult& result) {
+        int num_workers = pool.size();
+        placements.resize(count);
+        result.costs.resize(count);
+        result.found.resize(count);
+        for (int i = 0; i < num_workers; ++i) {
+            ranges[i].next.store(count * i / num_workers);
+            ranges[i].end = count * (i + 1) / num_workers;
+        }
+
+        pool.run([&](int worker) { work(worker, queries, result); });
+
+        result.offsets.resize(count + 1);
+        result.offsets[0] = 0;
+        for (size_t i = 0; i < count; ++i) {
+            result.offsets[i + 1] = result.offsets[i] + placements[i].length;
+        }
+        result.cells.resize(result.offsets[count]);
+        for (size_t i = 0; i < count; ++i) {
+            const Placement& placement = placements[i];
+            if (placement.length == 0) continue;
+            std::memcpy(&result.cells[result.offsets[i]], &worker_cells[placement.worker][placement.offset],
+                        placement.length * sizeof(Cell));
+        }
+    }
+
+    void solve(const std::vector<PathQuery>& queries, PathBatchResult& result) {
+        solve(queries.data(), queries.size(), result);
+    }
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include "grid_generator.h"
+#include "batch_pathfinder.h"
+
+// Latency measurement for the benchmark mode. Each query is timed on its
+// own with the steady clock in nanoseconds, and a run is summarised by
+// percentiles rather than a mean so that a few pathological queries do not
+// hide the typical case (or the reverse).
+struct BenchmarkResult {
+    std::string workload; // "random" or the map file of a scenario
+    int width;
+    int height;
+    uint32_t seed;
+    std::string solver;
+    std::string heuristic;
+    int queries;
+    int repeats;
+    int solved;
+    double mean_ns;
+    double p50_ns;
+    double p95_ns;
+    double p99_ns;
+    double queries_per_second;
+    double mean_expanded;
+    double mean_cost;
+};
+
+// Nearest-rank percentile of ascending samples, p in [0, 100]
+double percentile(const std::vector<long long>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+    rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+    return static_cast<double>(sorted[rank - 1]);
+}
+
+// Times `repeats` passes over the queries after `warmup` untimed queries
+// (taken round-robin from the same list). Solver needs findPath(start,
+// goal), getPathCost() and getNodesExpanded(). Identity fields of the
+// result (workload, solver, ...) are left for the caller.
+template <class Solver>
+BenchmarkResult measureQueries(Solver& solver, const PathQuery* queries, size_t count, int warmup, int repeats) {
+    BenchmarkResult result = BenchmarkResult();
+    result.queries = count;
+    result.repeats = repeats;
+    if (count == 0) return result;
+
+    for (int i = 0; i < warmup; ++i) {
+        const PathQuery& query = queries[i % count];
+        solver.findPath(query.start, query.goal);
+    }
+
+    std::vector<long long> samples;
+    samples.reserve(count * repeats);
+    long long total_ns = 0;
+    double expanded = 0, cost = 0;
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < count; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            bool found = solver.findPath(queries[i].start, queries[i].goal);
+            auto end = std::chrono::steady_clock::now();
+            long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            samples.push_back(ns);
+            total_ns += ns;
+            if (r == 0) {
+                expanded += solver.getNodesExpanded();
+                if (found) {
+                    result.solved++;
+                    cost += solver.getPathCost();
+                }
+            }
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    result.mean_ns = static_cast<double>(total_ns) / samples.size();
+    result.p50_ns = percentile(samples, 50);
+    result.p95_ns = percentile(samples, 95);
+    result.p99_ns = percentile(samples, 99);
+    result.queries_per_second = total_ns > 0 ? samples.size() * 1e9 / total_ns : 0;
+    result.mean_expanded = expanded / count;
+    result.mean_cost = result.solved ? cost / result.solved : 0;
+    return result;
+}
+
+// One row per result. `label` names the build or configuration so that
+// files from different builds can be compared (compare_benchmarks.py).
+bool writeBenchmarkCsv(const std::string& path, const std::string& label, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path.c_str());
+    if (!out) return false;
+    out << "Label,Workload,Width,Height,Seed,Solver,Heuristic,Queries,Repeats,Solved,"
+        << "MeanNs,P50Ns,P95Ns,P99Ns,QueriesPerSec,MeanNodesExpanded,MeanPathCost\n";
+    out.precision(12);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        out << label << "," << r.workload << "," << r.width << "," << r.height << "," << r.seed << ","
+            << r.solver << "," << r.heuristic << "," << r.queries << "," << r.repeats << "," << r.solved << ","
+            << r.mean_ns << "," << r.p50_ns << "," << r.p95_ns << "," << r.p99_ns << ","
+            << r.queries_per_second << "," << r.mean_expanded << "," << r.mean_cost << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef BIDIRECTIONAL_ASTAR_H
+#define BIDIRECTIONAL_ASTAR_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "search_state.h"
+#include "open_list.h"
+
+// Bidirectional A*: one search grows from the start towards the goal and
+// another from the goal towards the start. Every time a side reaches a
+// cell the other side has already reached, the joined cost becomes a
+// candidate for the best path cost mu. The search stops once mu is no
+// larger than the bigger of the two sides' minimum f-costs, at which point
+// no unexplored path can be cheaper, so the path is optimal for any
+// consistent heuristic (Octile, Chebyshev).
+//
+// In sequential mode the side with the smaller open list expands next. In
+// threaded mode each side runs on its own thread and reads the other
+// side's costs through per-cell atomics.
+class BidirectionalAStar {
+private:
+    static const int FORWARD = 0;
+    static const int BACKWARD = 1;
+
+    struct Side {
+        SearchState state;
+        QuaternaryHeapOpenList open_list;
+        Cell origin;
+        Cell target;
+        int nodes_expanded;
+        // Threaded mode only: costs visible to the other side. A cost is
+        // current when its stamp matches published_generation.
+        std::unique_ptr<std::atomic<double>[]> published_g;
+        std::unique_ptr<std::atomic<uint32_t>[]> published_stamp;
+        std::atomic<double> min_f;
+    };
+
+    const Grid& grid;
+    Heuristic heuristic;
+    bool threaded;
+    Side sides[2];
+    int published_size;
+    uint32_t published_generation;
+    std::mutex best_mutex;
+    std::atomic<double> best_cost;
+    int meet_key;
+    std::atomic<bool> done;
+    std::vector<Cell> path;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    int getNeighbors(const Cell& cell, Cell* neighbors) const {
+        static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
+        int count = 0;
+        for (int i = 0; i < 8; ++i) {
+            int new_x = cell.x + dx[i];
+            int new_y = cell.y + dy[i];
+            if (!grid.isObstacle(new_x, new_y)) {
+                Cell neighbor = {new_x, new_y};
+                neighbors[count++] = neighbor;
+            }
+        }
+        return count;
+    }
+
+    double getMoveCost(const Cell& from, const Cell& to) const {
+        if (from.x != to.x && from.y != to.y) {
+            return 1.414; // sqrt(2)
+        }
+        return 1.0;
+    }
+
+    void offerMeeting(double cost, int key) {
+        if (cost >= best_cost.load()) return;
+        std::lock_guard<std::mutex> lock(best_mutex);
+        if (cost < best_cost.load()) {
+            best_cost.store(cost);
+            meet_key = key;
+        }
+    }
+
+    // Records g on side `s` and checks the other side for a meeting
+    void reach(int s, int key, double g, int parent) {
+        Side& side = sides[s];
+        side.state.open(key, g, parent);
+        const Side& other = sides[1 - s];
+        if (threaded) {
+            side.published_g[key].store(g, std::memory_order_relaxed);
+            side.published_stamp[key].store(published_generation);
+            if (other.published_stamp[key].load() == published_generation) {
+                offerMeeting(g + other.published_g[key].load(std::memory_order_relaxed), key);
+            }
+        } else if (other.state.status(key) != SearchState::UNSEEN) {
+            offerMeeting(g + other.state.g(key), key);
+        }
+    }
+
+    double otherMinF(int s) {
+        if (threaded) return sides[1 - s].min_f.load();
+        const Side& other = sides[1 - s];
+        return other.open_list.empty() ? std::numeric_limits<double>::infinity()
+                                       : other.open_list.topPriority();
+    }
+
+    // Expands one node of side s; returns false when this side is finished
+    bool step(int s) {
+        Side& side = sides[s];
+        if (side.open_list.empty()) {
+            // Exhausted: every cell this side reached has its exact cost
+            int target_key = cellToKey(side.target);
+            if (side.state.status(target_key) != SearchState::UNSEEN) {
+                offerMeeting(side.state.g(target_key), target_key);
+            }
+            return false;
+        }
+
+        double min_f = side.open_list.topPriority();
+        if (threaded) side.min_f.store(min_f);
+        if (best_cost.load() <= std::max(min_f, otherMinF(s))) return false;
+
+        int current_key = side.open_list.pop();
+        side.state.close(current_key);
+        side.nodes_expanded++;
+
+        Cell current = keyToCell(current_key);
+        double current_g = side.state.g(current_key);
+        Cell neighbors[8];
+        int count = getNeighbors(current, neighbors);
+        for (int i = 0; i < count; ++i) {
+            const Cell& neighbor_cell = neighbors[i];
+            double new_g_cost = current_g + getMoveCost(current, neighbor_cell);
+            int neighbor_key = cellToKey(neighbor_cell);
+            SearchState::Status status = side.state.status(neighbor_key);
+
+            if (status == SearchState::UNSEEN) {
+                reach(s, neighbor_key, new_g_cost, current_key);
+                side.open_list.push(neighbor_key, new_g_cost + heuristic(neighbor_cell, side.target));
+            } else if (new_g_cost < side.state.g(neighbor_key)) {
+                double f_cost = new_g_cost + heuristic(neighbor_cell, side.target);
+                reach(s, neighbor_key, new_g_cost, current_key);
+                if (status == SearchState::CLOSED) {
+                    side.open_list.push(neighbor_key, f_cost);
+                } else {
+                    side.open_list.decrease(neighbor_key, f_cost);
+                }
+            }
+        }
+        return true;
+    }
+
+    void runSide(int s) {
+        while (!done.load() && step(s)) {
+        }
+        done.store(true);
+    }
+
+    void reconstructPath() {
+        path.clear();
+        for (int key = meet_key; key != -1; key = sides[FORWARD].state.parent(key)) {
+            path.push_back(keyToCell(key));
+        }
+        std::reverse(path.begin(), path.end());
+        for (int key = sides[BACKWARD].state.parent(meet_key); key != -1; key = sides[BACKWARD].state.parent(key)) {
+            path.push_back(keyToCell(key));
+        }
+    }
+
+    void preparePublished(int num_cells) {
+        if (published_size != num_cells) {
+            for (int s = 0; s < 2; ++s) {
+                sides[s].published_g.reset(new std::atomic<double>[num_cells]);
+                sides[s].published_stamp.reset(new std::atomic<uint32_t>[num_cells]);
+            }
+            published_size = num_cells;
+            published_generation = 0;
+        }
+        if (published_generation == 0 || ++published_generation == 0) {
+            for (int s = 0; s < 2; ++s) {
+                for (int i = 0; i < num_cells; ++i) sides[s].published_stamp[i].store(0, std::memory_order_relaxed);
+            }
+            published_generation = 1;
+        }
+    }
+
+public:
+    BidirectionalAStar(const Grid& g, Heuristic h, bool use_threads = false)
+        : grid(g), heuristic(h), threaded(use_threads), published_size(0), published_generation(0),
+          best_cost(0), meet_key(-1), done(false) {
+        sides[FORWARD].nodes_expanded = sides[BACKWARD].nodes_expanded = 0;
+    }
+
+    bool findPath() {
+        return findPath(grid.start, grid.goal);
+    }
+
+    bool findPath(const Cell& start, const Cell& goal) {
+        int num_cells = grid.width * grid.height;
+        if (threaded) preparePublished(num_cells);
+        path.clear();
+        best_cost.store(std::numeric_limits<double>::infinity());
+        meet_key = -1;
+        done.store(false);
+
+        sides[FORWARD].origin = sides[BACKWARD].target = start;
+        sides[FORWARD].target = sides[BACKWARD].origin = goal;
+        for (int s = 0; s < 2; ++s) {
+            Side& side = sides[s];
+            side.state.reset(num_cells);
+            side.open_list.reset(num_cells);
+            side.nodes_expanded = 0;
+            side.min_f.store(heuristic(side.origin, side.target));
+        }
+        for (int s = 0; s < 2; ++s) {
+            Side& side = sides[s];
+            int origin_key = cellToKey(side.origin);
+            reach(s, origin_key, 0, -1);
+            side.open_list.push(origin_key, heuristic(side.origin, side.target));
+        }
+
+        if (threaded) {
+            std::thread backward(&BidirectionalAStar::runSide, this, BACKWARD);
+            runSide(FORWARD);
+            backward.join();
+        } else {
+            while (true) {
+                int s = sides[FORWARD].open_list.size() <= sides[BACKWARD].open_list.size() ? FORWARD : BACKWARD;
+                if (!step(s)) break;
+            }
+        }
+
+        if (meet_key == -1) return false; // No path found
+        reconstructPath();
+        return true;
+    }
+
+    int getPathLength() const {
+        return path.size();
+    }
+
+    double getPathCost() const {
+        return path.empty() ? 0 : best_cost.load();
+    }
+
+    int getNodesExpanded() const {
+        return sides[FORWARD].nodes_expanded + sides[BACKWARD].nodes_expanded;
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+};
+
+#endif
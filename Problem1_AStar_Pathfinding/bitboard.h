@@ -0,0 +1,312 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "grid_generator.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Breadth-first floods over the free cells of a Grid, 64 cells per machine
+// word. A flood step grows the whole frontier at once: OR the rows above
+// and below into each row, OR in the row shifted one bit left and right
+// (carrying between words), then keep only free, unvisited cells. That is
+// one 8-connected BFS level, the same moves AStar makes. Rows are cut into
+// blocks of 256 cells and a flood keeps a bitmask of the blocks holding
+// frontier cells, so each level only touches blocks at or next to the
+// frontier. With AVX2 (-mavx2 or -march=native) a block is one vector;
+// otherwise a scalar loop handles its four words.
+//
+// reachable() floods from both cells in lockstep and stops as soon as the
+// floods touch or one of them runs out of cells, so pairs in different
+// components are rejected after exploring only the smaller side.
+// distanceField() labels every reachable cell with its BFS level (number
+// of moves). Each move costs at least 1, so the level is a lower bound on
+// the A* path cost and an admissible heuristic towards the source.
+//
+// The flood works on a copy of the obstacle bits; call refresh() after
+// editing the grid.
+class BitboardFlood {
+private:
+    static const int BLOCK_WORDS = 4;
+
+    // Bits of one flood, in the padded layout: row y is words
+    // [(y + 1) * stride, (y + 2) * stride), column x is bit x % 64 of word
+    // x / 64 + 1. Guard rows and guard words stay zero. Block masks hold
+    // mask_words words per row, bit b for block b (words 1 + 4b ... 4 + 4b).
+    struct Flood {
+        std::vector<uint64_t> visited;
+        std::vector<uint64_t> frontier;
+        std::vector<uint64_t> next;
+        std::vector<uint64_t> frontier_blocks;
+        std::vector<uint64_t> next_blocks;
+        std::vector<int> rows;      // rows holding frontier bits, ascending
+        std::vector<int> next_rows;
+        int touched_lo, touched_hi; // rows that may hold visited bits
+    };
+
+    int width;
+    int height;
+    int blocks;     // blocks per row
+    int stride;     // blocks * 4 words + 2 guard words
+    int mask_words; // words per row of a block mask
+    uint64_t last_mask; // valid block bits of the last mask word
+    std::vector<uint64_t> free_bits;
+    std::vector<uint64_t> active;
+    Flood floods[2];
+
+    size_t rowOffset(int y) const {
+        return static_cast<size_t>(y + 1) * stride;
+    }
+
+    size_t maskOffset(int y) const {
+        return static_cast<size_t>(y + 1) * mask_words;
+    }
+
+    void startFlood(Flood& flood, const Cell& source) {
+        size_t size = static_cast<size_t>(height + 2) * stride;
+        if (flood.visited.size() != size) {
+            flood.visited.assign(size, 0);
+            flood.frontier.assign(size, 0);
+            flood.next.assign(size, 0);
+            flood.frontier_blocks.assign(static_cast<size_t>(height + 2) * mask_words, 0);
+            flood.next_blocks.assign(static_cast<size_t>(height + 2) * mask_words, 0);
+        }
+        uint64_t bit = uint64_t(1) << (source.x & 63);
+        size_t word = rowOffset(source.y) + (source.x >> 6) + 1;
+        flood.visited[word] = flood.frontier[word] = bit;
+        int block = (source.x >> 6) / BLOCK_WORDS;
+        flood.frontier_blocks[maskOffset(source.y) + block / 64] = uint64_t(1) << (block % 64);
+        flood.rows.assign(1, source.y);
+        flood.touched_lo = flood.touched_hi = source.y;
+    }
+
+    // Zeroes every row the flood wrote, ready for the next query
+    void clearFlood(Flood& flood) {
+        clearFrontier(flood.frontier, flood.frontier_blocks, flood.rows);
+        size_t begin = rowOffset(flood.touched_lo);
+        size_t count = static_cast<size_t>(flood.touched_hi - flood.touched_lo + 1) * stride;
+        std::memset(&flood.visited[begin], 0, count * sizeof(uint64_t));
+    }
+
+    // Zeroes the active blocks of the given rows and their masks
+    void clearFrontier(std::vector<uint64_t>& bits, std::vector<uint64_t>& masks, const std::vector<int>& rows) {
+        for (size_t r = 0; r < rows.size(); ++r) {
+            int y = rows[r];
+            uint64_t* mask = &masks[maskOffset(y)];
+            for (int j = 0; j < mask_words; ++j) {
+                for (uint64_t m = mask[j]; m; m &= m - 1) {
+                    int block = j * 64 + __builtin_ctzll(m);
+                    std::memset(&bits[rowOffset(y) + 1 + block * BLOCK_WORDS], 0, BLOCK_WORDS * sizeof(uint64_t));
+                }
+                mask[j] = 0;
+            }
+        }
+    }
+
+    // One block of next = dilate(frontier) & free & ~visited, and
+    // visited |= next. above/row/below point at the block's first word in
+    // the three frontier rows. Returns true if any cell was added.
+    bool expandBlock(const uint64_t* above, const uint64_t* row, const uint64_t* below, const uint64_t* free_block,
+                     uint64_t* visited, uint64_t* next) const {
+#ifdef __AVX2__
+        __m256i t = _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(above)),
+                                                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row))),
+                                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below)));
+        __m256i left = _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(above - 1)),
+                                                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row - 1))),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below - 1)));
+        __m256i right = _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + 1)),
+                                                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + 1))),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + 1)));
+        __m256i grown = _mm256_or_si256(
+            _mm256_or_si256(t, _mm256_or_si256(_mm256_slli_epi64(t, 1), _mm256_srli_epi64(left, 63))),
+            _mm256_or_si256(_mm256_srli_epi64(t, 1), _mm256_slli_epi64(right, 63)));
+        __m256i seen = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(visited));
+        __m256i open = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(free_block));
+        __m256i fresh = _mm256_andnot_si256(seen, _mm256_and_si256(grown, open));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(next), fresh);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(visited), _mm256_or_si256(seen, fresh));
+        return !_mm256_testz_si256(fresh, fresh);
+#else
+        uint64_t any = 0;
+        for (int k = 0; k < BLOCK_WORDS; ++k) {
+            uint64_t t = above[k] | row[k] | below[k];
+            uint64_t left = above[k - 1] | row[k - 1] | below[k - 1];
+            uint64_t right = above[k + 1] | row[k + 1] | below[k + 1];
+            uint64_t grown = t | (t << 1) | (left >> 63) | (t >> 1) | (right << 63);
+            uint64_t fresh = grown & free_block[k] & ~visited[k];
+            next[k] = fresh;
+            visited[k] |= fresh;
+            any |= fresh;
+        }
+        return any != 0;
+#endif
+    }
+
+    // Expands the frontier blocks at or beside row y into next; true if
+    // row y gained cells
+    bool expandRow(Flood& flood, int y) {
+        // Blocks at or beside a frontier block in this or an adjacent row
+        const uint64_t* above = &flood.frontier_blocks[maskOffset(y - 1)];
+        const uint64_t* here = &flood.frontier_blocks[maskOffset(y)];
+        const uint64_t* below = &flood.frontier_blocks[maskOffset(y + 1)];
+        for (int j = 0; j < mask_words; ++j) active[j] = above[j] | here[j] | below[j];
+        uint64_t previous = 0;
+        for (int j = 0; j < mask_words; ++j) {
+            uint64_t m = active[j];
+            uint64_t following = j + 1 < mask_words ? active[j + 1] : 0;
+            active[j] = m | (m << 1) | (m >> 1) | (previous >> 63) | (following << 63);
+            previous = m;
+        }
+        active[mask_words - 1] &= last_mask;
+
+        size_t row = rowOffset(y);
+        uint64_t* next_mask = &flood.next_blocks[maskOffset(y)];
+        bool any = false;
+        for (int j = 0; j < mask_words; ++j) {
+            for (uint64_t m = active[j]; m; m &= m - 1) {
+                int block = j * 64 + __builtin_ctzll(m);
+                size_t word = row + 1 + block * BLOCK_WORDS;
+                if (expandBlock(&flood.frontier[word - stride], &flood.frontier[word], &flood.frontier[word + stride],
+                                &free_bits[word], &flood.visited[word], &flood.next[word])) {
+                    next_mask[j] |= uint64_t(1) << (block % 64);
+                    any = true;
+                }
+            }
+        }
+        return any;
+    }
+
+    // Advances the flood by one BFS level; false once it adds no cell
+    bool step(Flood& flood) {
+        flood.next_rows.clear();
+        int last = -1;
+        for (size_t r = 0; r < flood.rows.size(); ++r) {
+            // Rows at or next to a frontier row, each once and in order
+            int first = std::max(flood.rows[r] - 1, std::max(last + 1, 0));
+            int end = std::min(flood.rows[r] + 1, height - 1);
+            for (int y = first; y <= end; ++y) {
+                if (expandRow(flood, y)) flood.next_rows.push_back(y);
+            }
+            last = std::max(last, end);
+        }
+        flood.touched_lo = std::min(flood.touched_lo, std::max(flood.rows.front() - 1, 0));
+        flood.touched_hi = std::max(flood.touched_hi, std::min(flood.rows.back() + 1, height - 1));
+        // The old frontier becomes the next buffer, which must read as empty
+        clearFrontier(flood.frontier, flood.frontier_blocks, flood.rows);
+        flood.frontier.swap(flood.next);
+        flood.frontier_blocks.swap(flood.next_blocks);
+        flood.rows.swap(flood.next_rows);
+        return !flood.rows.empty();
+    }
+
+    bool overlaps(const Flood& flood, const Flood& other) const {
+        for (size_t r = 0; r < flood.rows.size(); ++r) {
+            int y = flood.rows[r];
+            const uint64_t* mask = &flood.frontier_blocks[maskOffset(y)];
+            for (int j = 0; j < mask_words; ++j) {
+                for (uint64_t m = mask[j]; m; m &= m - 1) {
+                    size_t word = rowOffset(y) + 1 + (j * 64 + __builtin_ctzll(m)) * BLOCK_WORDS;
+                    for (int k = 0; k < BLOCK_WORDS; ++k) {
+                        if (flood.frontier[word + k] & other.visited[word + k]) return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+public:
+    explicit BitboardFlood(const Grid& grid) {
+        refresh(grid);
+    }
+
+    // Copies the free cells of grid
+    void refresh(const Grid& grid) {
+        width = grid.width;
+        height = grid.height;
+        int words = (width + 63) / 64;
+        blocks = (words + BLOCK_WORDS - 1) / BLOCK_WORDS;
+        stride = blocks * BLOCK_WORDS + 2;
+        mask_words = (blocks + 63) / 64;
+        last_mask = blocks % 64 ? (uint64_t(1) << (blocks % 64)) - 1 : ~uint64_t(0);
+        free_bits.assign(static_cast<size_t>(height + 2) * stride, 0);
+        for (int y = 0; y < height; ++y) {
+            for (int i = 0; i < words; ++i) {
+                // rowBits() reads columns past the edge as blocked
+                free_bits[rowOffset(y) + i + 1] = ~grid.rowBits(y, i * 64);
+            }
+        }
+        active.assign(mask_words, 0);
+        for (int f = 0; f < 2; ++f) {
+            floods[f].visited.clear();
+            floods[f].frontier.clear();
+            floods[f].next.clear();
+        }
+    }
+
+    bool isFree(const Cell& cell) const {
+        return cell.x >= 0 && cell.x < width && cell.y >= 0 && cell.y < height &&
+               ((free_bits[rowOffset(cell.y) + (cell.x >> 6) + 1] >> (cell.x & 63)) & 1);
+    }
+
+    // True if a path from a to b exists
+    bool reachable(const Cell& a, const Cell& b) {
+        if (!isFree(a) || !isFree(b)) return false;
+        if (a == b) return true;
+        startFlood(floods[0], a);
+        startFlood(floods[1], b);
+        bool result = false;
+        while (true) {
+            if (!step(floods[0])) break;
+            if (overlaps(floods[0], floods[1])) {
+                result = true;
+                break;
+            }
+            if (!step(floods[1])) break;
+            if (overlaps(floods[1], floods[0])) {
+                result = true;
+                break;
+            }
+        }
+        clearFlood(floods[0]);
+        clearFlood(floods[1]);
+        return result;
+    }
+
+    // distances[y * width + x] = BFS level of (x, y) from source, -1 if
+    // unreachable
+    void distanceField(const Cell& source, std::vector<int>& distances) {
+        distances.assign(static_cast<size_t>(width) * height, -1);
+        if (!isFree(source)) return;
+        Flood& flood = floods[0];
+        startFlood(flood, source);
+        distances[static_cast<size_t>(source.y) * width + source.x] = 0;
+        for (int level = 1; step(flood); ++level) {
+            for (size_t r = 0; r < flood.rows.size(); ++r) {
+                int y = flood.rows[r];
+                const uint64_t* mask = &flood.frontier_blocks[maskOffset(y)];
+                for (int j = 0; j < mask_words; ++j) {
+                    for (uint64_t m = mask[j]; m; m &= m - 1) {
+                        int block = j * 64 + __builtin_ctzll(m);
+                        const uint64_t* words = &flood.frontier[rowOffset(y) + 1 + block * BLOCK_WORDS];
+                        for (int k = 0; k < BLOCK_WORDS; ++k) {
+                            for (uint64_t bits = words[k]; bits; bits &= bits - 1) {
+                                int x = (block * BLOCK_WORDS + k) * 64 + __builtin_ctzll(bits);
+                                distances[static_cast<size_t>(y) * width + x] = level;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        clearFlood(flood);
+    }
+};
+
+#endif
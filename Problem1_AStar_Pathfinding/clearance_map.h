@@ -0,0 +1,224 @@
+#ifndef CLEARANCE_MAP_H
+#define CLEARANCE_MAP_H
+
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include "grid_generator.h"
+#include "thread_pool.h"
+
+// Distance from every cell to the nearest obstacle, so a robot with a
+// round footprint is checked with one lookup per cell instead of one per
+// cell under its footprint. A robot of radius r fits on a cell when every
+// obstacle cell's center is farther than r from the cell's center; radius
+// 0 is the point robot of AStar. The map's edge counts as obstacles.
+//
+// Distances are exact Euclidean ones between cell centers, kept squared as
+// integers, and computed with the linear-time separable transform of
+// Felzenszwalb and Huttenlocher: first the distance to the nearest
+// obstacle in each column, then per row the lower envelope of the
+// parabolas those give. Columns, then rows, are spread over the thread
+// pool.
+//
+// Values are capped just above max_radius, which is all lookups ever
+// need. That bounds the effect of an edit: update() recomputes only the
+// cells within the cap of the edited cells, reading obstacles twice as far.
+// The map references the grid; pass the changed cells to update() after
+// editing obstacles.
+class ClearanceMap {
+private:
+    static const uint32_t FAR = std::numeric_limits<uint32_t>::max();
+    // Below this many cells a window is transformed on the calling thread
+    static const long long PARALLEL_WINDOW = 1 << 16;
+
+    const Grid& grid;
+    ThreadPool pool;
+    int cap;             // cells; values are clamped to cap * cap
+    uint32_t cap_squared;
+    std::vector<uint32_t> squared;
+    std::vector<uint32_t> columns; // window scratch: squared column distances
+    std::vector<uint32_t> window_out;
+    std::vector<std::vector<int> > envelope_sites;
+    std::vector<std::vector<double> > envelope_bounds;
+
+    // Squared distances over the window [x0, x1) x [y0, y1), which may
+    // include the blocked ring just outside the map, into window_out.
+    // Obstacles outside the window are ignored.
+    void transform(int x0, int y0, int x1, int y1) {
+        int w = x1 - x0, h = y1 - y0;
+        columns.assign(static_cast<size_t>(w) * h, FAR);
+        window_out.assign(static_cast<size_t>(w) * h, FAR);
+        bool parallel = static_cast<long long>(w) * h >= PARALLEL_WINDOW && pool.size() > 1;
+
+        std::atomic<int> next_column(0);
+        auto column_pass = [&](int) {
+            for (int i = next_column++; i < w; i = next_column++) {
+                uint32_t* out = columns.data() + i;
+                int last = -1; // row of the last obstacle seen, window coordinates
+                for (int j = 0; j < h; ++j) {
+                    if (grid.isObstacle(x0 + i, y0 + j)) last = j;
+                    if (last >= 0) out[static_cast<size_t>(j) * w] = static_cast<uint32_t>(j - last);
+                }
+                last = -1;
+                for (int j = h - 1; j >= 0; --j) {
+                    if (grid.isObstacle(x0 + i, y0 + j)) last = j;
+                    uint32_t& cell = out[static_cast<size_t>(j) * w];
+                    if (last >= 0 && static_cast<uint32_t>(last - j) < cell) cell = last - j;
+                }
+                for (int j = 0; j < h; ++j) {
+                    uint32_t& cell = out[static_cast<size_t>(j) * w];
+                    if (cell != FAR) cell *= cell;
+                }
+            }
+        };
+
+        std::atomic<int> next_row(0);
+        auto row_pass = [&](int worker) {
+            std::vector<int>& sites = envelope_sites[worker];
+            std::vector<double>& bounds = envelope_bounds[worker];
+            for (int j = next_row++; j < h; j = next_row++) {
+                const uint32_t* f = columns.data() + static_cast<size_t>(j) * w;
+                uint32_t* out = window_out.data() + static_cast<size_t>(j) * w;
+                // Lower envelope of the parabolas (x - q)^2 + f[q]; bounds[k]
+                // is where sites[k] starts to be the lowest
+                sites.clear();
+                bounds.clear();
+                for (int q = 0; q < w; ++q) {
+                    if (f[q] == FAR) continue;
+                    double start = -std::numeric_limits<double>::infinity();
+                    while (!sites.empty()) {
+                        int p = sites.back();
+                        start = ((static_cast<double>(f[q]) + double(q) * q) - (static_cast<double>(f[p]) + double(p) * p)) /
+                                (2.0 * (q - p));
+                        if (start > bounds.back()) break;
+                        sites.pop_back();
+                        bounds.pop_back();
+                        start = -std::numeric_limits<double>::infinity();
+                    }
+                    sites.push_back(q);
+                    bounds.push_back(start);
+                }
+                size_t k = 0;
+                for (int x = 0; x < w && !sites.empty(); ++x) {
+                    while (k + 1 < sites.size() && bounds[k + 1] <= x) k++;
+                    long long dx = x - sites[k];
+                    out[x] = static_cast<uint32_t>(std::min<long long>(dx * dx + f[sites[k]], FAR));
+                }
+            }
+        };
+
+        if (parallel) {
+            pool.run(column_pass);
+            pool.run(row_pass);
+        } else {
+            column_pass(0);
+            row_pass(0);
+        }
+    }
+
+    // Recomputes the cells of [x0, x1) x [y0, y1), clipped to the map
+    void refresh(int x0, int y0, int x1, int y1) {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, grid.width);
+        y1 = std::min(y1, grid.height);
+        if (x0 >= x1 || y0 >= y1) return;
+        // Every obstacle within the cap of the refreshed cells, the ring
+        // around the map included
+        int wx0 = std::max(x0 - cap, -1), wy0 = std::max(y0 - cap, -1);
+        int wx1 = std::min(x1 + cap, grid.width + 1), wy1 = std::min(y1 + cap, grid.height + 1);
+        transform(wx0, wy0, wx1, wy1);
+        int w = wx1 - wx0;
+        for (int y = y0; y < y1; ++y) {
+            const uint32_t* row = window_out.data() + static_cast<size_t>(y - wy0) * w - wx0;
+            for (int x = x0; x < x1; ++x) {
+                squared[static_cast<size_t>(y) * grid.width + x] = std::min(row[x], cap_squared);
+            }
+        }
+    }
+
+public:
+    // max_radius is the largest radius fits() will be asked about;
+    // num_threads <= 0 uses every hardware thread
+    ClearanceMap(const Grid& g, double max_radius, int num_threads = 0)
+        : grid(g), pool(num_threads), cap(static_cast<int>(std::floor(std::max(max_radius, 0.0))) + 1),
+          cap_squared(static_cast<uint32_t>(cap) * cap), envelope_sites(pool.size()), envelope_bounds(pool.size()) {}
+
+    int threadCount() const {
+        return pool.size();
+    }
+
+    void build() {
+        squared.assign(static_cast<size_t>(grid.width) * grid.height, 0);
+        refresh(0, 0, grid.width, grid.height);
+    }
+
+    // Repairs the map after the obstacle state of `changed` cells flipped.
+    // The cells within the cap of their bounding box are recomputed.
+    void update(const std::vector<Cell>& changed) {
+        if (changed.empty()) return;
+        int x0 = grid.width, y0 = grid.height, x1 = -1, y1 = -1;
+        for (size_t i = 0; i < changed.size(); ++i) {
+            x0 = std::min(x0, changed[i].x);
+            y0 = std::min(y0, changed[i].y);
+            x1 = std::max(x1, changed[i].x);
+            y1 = std::max(y1, changed[i].y);
+        }
+        refresh(x0 - cap + 1, y0 - cap + 1, x1 + cap, y1 + cap);
+    }
+
+    // Squared distance to the nearest obstacle, at most the cap squared;
+    // 0 on obstacles
+    uint32_t squaredClearance(int x, int y) const {
+        return squared[static_cast<size_t>(y) * grid.width + x];
+    }
+
+    double clearance(int x, int y) const {
+        return std::sqrt(static_cast<double>(squaredClearance(x, y)));
+    }
+
+    // Whether a robot of this radius (at most max_radius) fits on the cell
+    bool fits(int x, int y, double radius) const {
+        return grid.isValidCell(x, y) && squaredClearance(x, y) > radius * radius;
+    }
+
+    size_t memoryBytes() const {
+        return squared.size() * sizeof(uint32_t);
+    }
+};
+
+const uint32_t ClearanceMap::FAR;
+const long long ClearanceMap::PARALLEL_WINDOW;
+
+// The grid as seen by a robot of a given radius: cells it does not fit on
+// read as obstacles. Has the interface of Grid that the templated solvers
+// need, so BasicAStar<..., ClearanceView> plans for the footprint with any
+// neighborhood and heuristic. Valid while the clearance map is.
+class ClearanceView {
+private:
+    const ClearanceMap* clearance;
+    double radius_squared;
+
+public:
+    Cell start;
+    Cell goal;
+    int width, height;
+
+    ClearanceView(const Grid& grid, const ClearanceMap& map, double radius)
+        : clearance(&map), radius_squared(radius * radius), start(grid.start), goal(grid.goal),
+          width(grid.width), height(grid.height) {}
+
+    bool isValidCell(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+
+    bool isObstacle(int x, int y) const {
+        if (!isValidCell(x, y)) return true;
+        return clearance->squaredClearance(x, y) <= radius_squared;
+    }
+};
+
+#endif
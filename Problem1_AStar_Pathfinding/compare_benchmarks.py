@@ -0,0 +1,49 @@
+import argparse
+import csv
+import sys
+
+KEY_COLUMNS = ['Workload', 'Width', 'Height', 'Seed', 'Solver', 'Heuristic']
+METRICS = ['P50Ns', 'P95Ns', 'P99Ns']
+
+
+def read_results(path):
+    with open(path, newline='') as f:
+        return {tuple(row[c] for c in KEY_COLUMNS): row for row in csv.DictReader(f)}
+
+
+def compare(baseline_path, current_path, threshold):
+    baseline = read_results(baseline_path)
+    current = read_results(current_path)
+
+    regressions = 0
+    print(f"{'Configuration':<48} " + " ".join(f"{m:>10}" for m in METRICS))
+    for key, row in current.items():
+        if key not in baseline:
+            continue
+        name = f"{key[4]}/{key[5]} {key[1]}x{key[2]} {key[0]}"
+        ratios = []
+        for metric in METRICS:
+            before = float(baseline[key][metric])
+            after = float(row[metric])
+            ratios.append(after / before if before > 0 else 1.0)
+        slower = any(r > 1 + threshold for r in ratios)
+        regressions += slower
+        print(f"{name:<48} " + " ".join(f"{r:>9.3f}x" for r in ratios) + ("  REGRESSION" if slower else ""))
+        if baseline[key]['MeanPathCost'] != row['MeanPathCost']:
+            print(f"  path cost changed: {baseline[key]['MeanPathCost']} -> {row['MeanPathCost']}")
+
+    missing = [k for k in baseline if k not in current]
+    if missing:
+        print(f"{len(missing)} configurations of the baseline were not run")
+    print(f"{regressions} regression(s) above {threshold * 100:.0f}%")
+    return regressions
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='Compare two benchmark_data.csv files (current / baseline latency).')
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    parser.add_argument('--threshold', type=float, default=0.10,
+                        help='relative slowdown of any percentile that counts as a regression')
+    args = parser.parse_args()
+    sys.exit(1 if compare(args.baseline, args.current, args.threshold) else 0)
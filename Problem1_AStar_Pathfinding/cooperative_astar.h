@@ -0,0 +1,620 @@
+#ifndef COOPERATIVE_ASTAR_H
+#define COOPERATIVE_ASTAR_H
+
+#include <vector>
+#include <queue>
+#include <memory>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+#include <climits>
+#include <limits>
+#include "grid_generator.h"
+#include "batch_pathfinder.h"
+#include "heuristics.h"
+#include "thread_pool.h"
+
+// (cell, time) -> agent, in one open-addressing table with linear probing.
+// Entries are never removed individually; clear() empties the table.
+class ReservationTable {
+private:
+    struct Slot {
+        uint64_t key; // 0 marks an empty slot
+        int agent;
+    };
+
+    std::vector<Slot> slots;
+    size_t used;
+    int shift;
+
+    static uint64_t pack(int cell, int time) {
+        return ((static_cast<uint64_t>(cell) << 32) | static_cast<uint32_t>(time)) + 1;
+    }
+
+    size_t home(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift);
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.assign(old.size() * 2, Slot());
+        shift--;
+        used = 0;
+        for (size_t i = 0; i < old.size(); ++i) {
+            if (old[i].key) insert(old[i].key, old[i].agent);
+        }
+    }
+
+    void insert(uint64_t key, int agent) {
+        size_t mask = slots.size() - 1;
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            if (slots[i].key == key) {
+                slots[i].agent = agent;
+                return;
+            }
+            if (slots[i].key == 0) {
+                slots[i].key = key;
+                slots[i].agent = agent;
+                used++;
+                return;
+            }
+        }
+    }
+
+public:
+    ReservationTable() : slots(1024), used(0), shift(64 - 10) {}
+
+    void clear() {
+        std::fill(slots.begin(), slots.end(), Slot());
+        used = 0;
+    }
+
+    void reserve(int cell, int time, int agent) {
+        if ((used + 1) * 2 > slots.size()) grow();
+        insert(pack(cell, time), agent);
+    }
+
+    // Agent holding cell at time, -1 if none
+    int at(int cell, int time) const {
+        uint64_t key = pack(cell, time);
+        size_t mask = slots.size() - 1;
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            if (slots[i].key == key) return slots[i].agent;
+            if (slots[i].key == 0) return -1;
+        }
+    }
+
+    size_t size() const {
+        return used;
+    }
+
+    size_t memoryBytes() const {
+        return slots.size() * sizeof(Slot);
+    }
+};
+
+// Exact distance from any cell to one goal, ignoring other agents: a
+// reverse A* from the goal toward `target`, resumed whenever a cell it has
+// not closed yet is asked for (Silver's Reverse Resumable A*). Only the
+// cells the queries needed are stored. Moves are EightConnected.
+class GoalDistance {
+private:
+    struct Node {
+        double g;
+        bool closed;
+    };
+
+    struct Entry {
+        double f;
+        double g;
+        int cell;
+        bool operator<(const Entry& other) const {
+            return f != other.f ? f > other.f : g < other.g;
+        }
+    };
+
+    const Grid& grid;
+    Cell target;
+    std::unordered_map<int, Node> nodes;
+    std::priority_queue<Entry> open;
+
+public:
+    GoalDistance(const Grid& g, const Cell& goal, const Cell& target) : grid(g), target(target) {
+        int key = goal.y * grid.width + goal.x;
+        Node node = {0, false};
+        nodes[key] = node;
+        Entry entry = {octileDistance(goal, target), 0, key};
+        open.push(entry);
+    }
+
+    // Infinity when cell cannot reach the goal
+    double distance(const Cell& cell) {
+        int key = cell.y * grid.width + cell.x;
+        std::unordered_map<int, Node>::const_iterator found = nodes.find(key);
+        if (found != nodes.end() && found->second.closed) return found->second.g;
+
+        static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
+        while (!open.empty()) {
+            Entry top = open.top();
+            open.pop();
+            Node& current = nodes[top.cell];
+            if (current.closed || top.g > current.g) continue;
+            current.closed = true;
+
+            Cell from = {top.cell % grid.width, top.cell / grid.width};
+            for (int d = 0; d < 8; ++d) {
+                Cell next = {from.x + dx[d], from.y + dy[d]};
+                if (grid.isObstacle(next.x, next.y)) continue;
+                double g = top.g + (d < 4 ? 1.0 : 1.414);
+                std::pair<std::unordered_map<int, Node>::iterator, bool> inserted =
+                    nodes.insert(std::make_pair(next.y * grid.width + next.x, Node()));
+                Node& node = inserted.first->second;
+                if (!inserted.second && (node.closed || g >= node.g)) continue;
+                node.g = g;
+                node.closed = false;
+                Entry entry = {g + octileDistance(next, target), g, inserted.first->first};
+                open.push(entry);
+            }
+            if (top.cell == key) return top.g;
+        }
+        return std::numeric_limits<double>::infinity();
+    }
+
+    size_t size() const {
+        return nodes.size();
+    }
+};
+
+// Cooperative A* for a fleet on one grid. Agents are planned one after
+// another in priority order (their order in the query list) over (cell,
+// time): each time step an agent moves to a neighbour (1 or 1.414) or waits
+// (1), and may not enter a cell another agent holds at that time, swap
+// cells with one, or pass a cell where one has parked at its goal. Planned
+// paths are reserved so later agents route around them.
+//
+// The heuristic is the exact distance to the agent's goal ignoring other
+// agents, a GoalDistance kept per goal cell across plan() calls; call
+// clearCache() after editing the grid.
+//
+// Agents are split into groups whose individual shortest paths have
+// overlapping bounding boxes; groups are planned in parallel, each with its
+// own reservation table. Groups whose plans then conflict are merged and
+// planned again, until no two groups conflict. An agent for which no plan
+// exists within its horizon keeps an empty path and is ignored by the
+// others, as is an agent whose start or goal repeats an earlier agent's.
+class CooperativePlanner {
+private:
+    static const int MARGIN = 2; // cells added around each bounding box
+
+    struct Reservations {
+        ReservationTable table;
+        std::vector<int> parked;   // cell -> arrival time of the agent parked there
+        std::vector<int> last_use; // cell -> latest reserved time, -1 if none
+        std::vector<int> touched;  // cells with a last_use, for clear()
+
+        void clear(int cells) {
+            table.clear();
+            if (static_cast<int>(parked.size()) != cells) {
+                parked.assign(cells, INT_MAX);
+                last_use.assign(cells, -1);
+            } else {
+                for (size_t i = 0; i < touched.size(); ++i) {
+                    parked[touched[i]] = INT_MAX;
+                    last_use[touched[i]] = -1;
+                }
+            }
+            touched.clear();
+        }
+
+        void add(const std::vector<int>& cells, int agent) {
+            for (size_t t = 0; t < cells.size(); ++t) {
+                table.reserve(cells[t], static_cast<int>(t), agent);
+                if (last_use[cells[t]] < 0) touched.push_back(cells[t]);
+                last_use[cells[t]] = std::max(last_use[cells[t]], static_cast<int>(t));
+            }
+            parked[cells.back()] = static_cast<int>(cells.size()) - 1;
+        }
+
+        bool taken(int cell, int time) const {
+            return parked[cell] <= time || holder(cell, time) >= 0;
+        }
+
+        // Agent at cell at time, -1 if none; last_use spares most lookups
+        int holder(int cell, int time) const {
+            return last_use[cell] < time ? -1 : table.at(cell, time);
+        }
+
+        int lastUse(int cell) const {
+            return last_use[cell];
+        }
+    };
+
+    struct Node {
+        int cell;
+        int time;
+        double g;
+        int parent;
+        bool closed;
+    };
+
+    struct Entry {
+        double f;
+        double g;
+        int node;
+        // Lowest f first, then the deepest node
+        bool operator<(const Entry& other) const {
+            return f != other.f ? f > other.f : g < other.g;
+        }
+    };
+
+    // Scratch of one worker's space-time searches
+    struct Search {
+        std::vector<Node> nodes;
+        ReservationTable index; // (cell, time) -> node
+        std::priority_queue<Entry> open;
+        Reservations reservations;
+        std::vector<double> h;       // cell -> distance to the current goal
+        std::vector<uint32_t> h_for; // search h[cell] was filled by
+        uint32_t stamp;              // current search
+        long long expansions;
+    };
+
+    const Grid& grid;
+    ThreadPool pool;
+    int max_expansions;
+    std::vector<PathQuery> agents;
+    std::vector<std::vector<int> > paths; // cell key per time step
+    std::unordered_map<int, std::unique_ptr<GoalDistance> > distances; // by goal cell
+    std::vector<GoalDistance*> distance_of;                            // per agent, null if invalid
+    std::vector<int> group_of;
+    std::vector<std::vector<int> > groups;
+    std::vector<Search> searches;
+    int merge_rounds;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    int findGroup(std::vector<int>& parent, int agent) const {
+        while (parent[agent] != agent) agent = parent[agent] = parent[parent[agent]];
+        return agent;
+    }
+
+    // One GoalDistance per goal, created here so that workers never insert
+    void prepareAgents() {
+        std::unordered_map<int, int> starts, goals;
+        distance_of.assign(agents.size(), nullptr);
+        for (size_t i = 0; i < agents.size(); ++i) {
+            const PathQuery& agent = agents[i];
+            if (grid.isObstacle(agent.start.x, agent.start.y) || grid.isObstacle(agent.goal.x, agent.goal.y)) continue;
+            if (!starts.insert(std::make_pair(cellToKey(agent.start), 0)).second) continue;
+            if (!goals.insert(std::make_pair(cellToKey(agent.goal), 0)).second) continue;
+            std::unique_ptr<GoalDistance>& distance = distances[cellToKey(agent.goal)];
+            if (!distance) distance.reset(new GoalDistance(grid, agent.goal, agent.start));
+            distance_of[i] = distance.get();
+        }
+    }
+
+    // Initial groups: agents whose individual paths have overlapping
+    // bounding boxes
+    void initialGroups(std::vector<int>& parent) {
+        struct Box {
+            int x0, y0, x1, y1;
+        };
+        static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
+        std::vector<Box> boxes(agents.size());
+        for (size_t i = 0; i < agents.size(); ++i) {
+            Cell cell = agents[i].start;
+            Box box = {cell.x, cell.y, cell.x, cell.y};
+            boxes[i] = box;
+            if (!distance_of[i] || distance_of[i]->distance(cell) == std::numeric_limits<double>::infinity()) continue;
+            // Walk down the distances, one shortest path
+            while (!(cell == agents[i].goal)) {
+                Cell best = cell;
+                double best_cost = distance_of[i]->distance(cell);
+                for (int d = 0; d < 8; ++d) {
+                    Cell next = {cell.x + dx[d], cell.y + dy[d]};
+                    if (grid.isObstacle(next.x, next.y)) continue;
+                    double cost = (d < 4 ? 1.0 : 1.414) + distance_of[i]->distance(next);
+                    if (cost < best_cost + 1e-9) {
+                        best = next;
+                        best_cost = cost;
+                    }
+                }
+                cell = best;
+                boxes[i].x0 = std::min(boxes[i].x0, cell.x);
+                boxes[i].y0 = std::min(boxes[i].y0, cell.y);
+                boxes[i].x1 = std::max(boxes[i].x1, cell.x);
+                boxes[i].y1 = std::max(boxes[i].y1, cell.y);
+            }
+        }
+        for (size_t i = 0; i < agents.size(); ++i) {
+            for (size_t j = i + 1; j < agents.size(); ++j) {
+                const Box& a = boxes[i];
+                const Box& b = boxes[j];
+                if (a.x0 - MARGIN <= b.x1 && b.x0 - MARGIN <= a.x1 && a.y0 - MARGIN <= b.y1 && b.y0 - MARGIN <= a.y1) {
+                    parent[findGroup(parent, static_cast<int>(i))] = findGroup(parent, static_cast<int>(j));
+                }
+            }
+        }
+    }
+
+    double heuristic(int agent, const Cell& cell, Search& search) {
+        int key = cellToKey(cell);
+        if (search.h_for[key] != search.stamp) {
+            search.h[key] = distance_of[agent]->distance(cell);
+            search.h_for[key] = search.stamp;
+        }
+        return search.h[key];
+    }
+
+    bool planAgent(int agent, Search& search) {
+        std::vector<int>& path = paths[agent];
+        path.clear();
+        if (!distance_of[agent]) return false;
+        search.stamp++;
+        const Reservations& reservations = search.reservations;
+        Cell start = agents[agent].start;
+        int start_key = cellToKey(start), goal_key = cellToKey(agents[agent].goal);
+        double start_h = heuristic(agent, start, search);
+        if (start_h == std::numeric_limits<double>::infinity() || reservations.taken(start_key, 0)) return false;
+        // Long enough to outwait everyone planned before
+        int goal_free = reservations.lastUse(goal_key) + 1;
+        int horizon = static_cast<int>(2 * start_h) + goal_free + 64;
+
+        search.nodes.clear();
+        search.index.clear();
+        search.open = std::priority_queue<Entry>();
+        Node first = {start_key, 0, 0, -1, false};
+        search.nodes.push_back(first);
+        search.index.reserve(start_key, 0, 0);
+        Entry entry = {std::max(start_h, static_cast<double>(goal_free)), 0, 0};
+        search.open.push(entry);
+
+        static const int dx[] = {0, -1, 1, 0, 0, -1, -1, 1, 1};
+        static const int dy[] = {0, 0, 0, -1, 1, -1, 1, -1, 1};
+        int expansions = 0;
+        while (!search.open.empty() && expansions < max_expansions) {
+            Entry top = search.open.top();
+            search.open.pop();
+            Node current = search.nodes[top.node];
+            if (current.closed || top.g > current.g) continue;
+            search.nodes[top.node].closed = true;
+            expansions++;
+
+            if (current.cell == goal_key && current.time >= goal_free) {
+                for (int n = top.node; n != -1; n = search.nodes[n].parent) path.push_back(search.nodes[n].cell);
+                std::reverse(path.begin(), path.end());
+                search.expansions += expansions;
+                return true;
+            }
+            if (current.time >= horizon) continue;
+
+            Cell cell = keyToCell(current.cell);
+            // Whoever enters our cell next step must not be the one we meet
+            int entering = reservations.holder(current.cell, current.time + 1);
+            for (int d = 0; d < 9; ++d) {
+                int x = cell.x + dx[d], y = cell.y + dy[d];
+                if (grid.isObstacle(x, y)) continue;
+                Cell next_cell = {x, y};
+                int next = cellToKey(next_cell);
+                double distance = heuristic(agent, next_cell, search);
+                if (distance == std::numeric_limits<double>::infinity()) continue;
+                int time = current.time + 1;
+                if (reservations.taken(next, time) ||
+                    (entering >= 0 && d > 0 && reservations.holder(next, current.time) == entering)) {
+                    continue;
+                }
+                double g = current.g + (d == 0 ? 1.0 : (d < 5 ? 1.0 : 1.414));
+                int node = search.index.at(next, time);
+                if (node < 0) {
+                    node = static_cast<int>(search.nodes.size());
+                    Node created = {next, time, g, top.node, false};
+                    search.nodes.push_back(created);
+                    search.index.reserve(next, time, node);
+                } else {
+                    if (search.nodes[node].closed || g >= search.nodes[node].g) continue;
+                    search.nodes[node].g = g;
+                    search.nodes[node].parent = top.node;
+                }
+                // Every step costs at least 1, so arrival waits for goal_free
+                double h = std::max(distance, static_cast<double>(goal_free - time));
+                Entry pushed = {g + h, g, node};
+                search.open.push(pushed);
+            }
+        }
+        search.expansions += expansions;
+        return false;
+    }
+
+    void planGroup(const std::vector<int>& members, Search& search) {
+        search.reservations.clear(grid.width * grid.height);
+        if (search.h.empty()) {
+            search.h.resize(grid.width * grid.height);
+            search.h_for.resize(grid.width * grid.height);
+        }
+        for (size_t i = 0; i < members.size(); ++i) {
+            if (planAgent(members[i], search)) search.reservations.add(paths[members[i]], members[i]);
+        }
+    }
+
+    // Pairs of agents whose plans collide: same cell at the same time,
+    // swapped cells, or a cell passed after its owner parked there
+    void findConflicts(std::vector<std::pair<int, int> >& conflicts) const {
+        conflicts.clear();
+        ReservationTable table;
+        std::unordered_map<int, int> parked_by; // goal cell -> agent
+        for (size_t i = 0; i < agents.size(); ++i) {
+            const std::vector<int>& path = paths[i];
+            for (size_t t = 0; t < path.size(); ++t) {
+                int other = table.at(path[t], static_cast<int>(t));
+                if (other >= 0) conflicts.push_back(std::make_pair(other, static_cast<int>(i)));
+                else table.reserve(path[t], static_cast<int>(t), static_cast<int>(i));
+            }
+            if (!path.empty()) parked_by[path.back()] = static_cast<int>(i);
+        }
+        for (size_t i = 0; i < agents.size(); ++i) {
+            const std::vector<int>& path = paths[i];
+            for (size_t t = 0; t < path.size(); ++t) {
+                std::unordered_map<int, int>::const_iterator parked = parked_by.find(path[t]);
+                if (parked != parked_by.end() && parked->second != static_cast<int>(i) &&
+                    paths[parked->second].size() <= t + 1) {
+                    conflicts.push_back(std::make_pair(parked->second, static_cast<int>(i)));
+                }
+                if (t + 1 < path.size() && path[t + 1] != path[t]) {
+                    int other = table.at(path[t + 1], static_cast<int>(t));
+                    if (other >= 0 && other != static_cast<int>(i) && table.at(path[t], static_cast<int>(t) + 1) == other) {
+                        conflicts.push_back(std::make_pair(other, static_cast<int>(i)));
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    // num_threads <= 0 uses every hardware thread; max_expansions caps the
+    // space-time search of each agent
+    CooperativePlanner(const Grid& g, int num_threads = 0, int max_expansions = 200000)
+        : grid(g), pool(num_threads), max_expansions(max_expansions), searches(pool.size()), merge_rounds(0) {}
+
+    // Plans every agent; agents earlier in the list have priority. Returns
+    // the number of agents with a plan.
+    int plan(const std::vector<PathQuery>& queries) {
+        agents = queries;
+        paths.assign(agents.size(), std::vector<int>());
+        merge_rounds = 0;
+        for (size_t w = 0; w < searches.size(); ++w) searches[w].expansions = 0;
+        prepareAgents();
+
+        std::vector<int> parent(agents.size());
+        std::iota(parent.begin(), parent.end(), 0);
+        initialGroups(parent);
+
+        std::vector<char> dirty(agents.size(), 1); // groups to (re)plan, by root
+        std::vector<std::pair<int, int> > conflicts;
+        while (true) {
+            groups.clear();
+            group_of.assign(agents.size(), -1);
+            std::vector<int> group_index(agents.size(), -1);
+            std::vector<int> pending;
+            for (size_t i = 0; i < agents.size(); ++i) {
+                int root = findGroup(parent, static_cast<int>(i));
+                if (group_index[root] < 0) {
+                    group_index[root] = static_cast<int>(groups.size());
+                    groups.push_back(std::vector<int>());
+                    if (dirty[root]) pending.push_back(group_index[root]);
+                }
+                group_of[i] = group_index[root];
+                groups[group_index[root]].push_back(static_cast<int>(i)); // in priority order
+            }
+
+            // Largest groups first, so one long group does not finish last
+            std::sort(pending.begin(), pending.end(),
+                      [&](int a, int b) { return groups[a].size() > groups[b].size(); });
+            std::atomic<size_t> next(0);
+            pool.run([&](int worker) {
+                for (size_t p = next++; p < pending.size(); p = next++) planGroup(groups[pending[p]], searches[worker]);
+            });
+            std::fill(dirty.begin(), dirty.end(), 0);
+
+            // Merge the groups of every colliding pair and plan them again
+            findConflicts(conflicts);
+            std::vector<char> conflicted(groups.size(), 0);
+            bool merged = false;
+            for (size_t c = 0; c < conflicts.size(); ++c) {
+                int a = conflicts[c].first, b = conflicts[c].second;
+                if (group_of[a] == group_of[b]) continue;
+                conflicted[group_of[a]] = conflicted[group_of[b]] = 1;
+                int root_a = findGroup(parent, a), root_b = findGroup(parent, b);
+                if (root_a != root_b) parent[root_a] = root_b;
+                merged = true;
+            }
+            if (!merged) break;
+            for (size_t i = 0; i < agents.size(); ++i) {
+                if (conflicted[group_of[i]]) dirty[findGroup(parent, static_cast<int>(i))] = 1;
+            }
+            merge_rounds++;
+        }
+        return getSolvedCount();
+    }
+
+    // Drops the cached goal distances, for after the grid changed
+    void clearCache() {
+        distances.clear();
+    }
+
+    // Cells of the agent's plan, one per time step from 0; empty if none
+    std::vector<Cell> getPath(int agent) const {
+        std::vector<Cell> path;
+        for (size_t t = 0; t < paths[agent].size(); ++t) path.push_back(keyToCell(paths[agent][t]));
+        return path;
+    }
+
+    bool isSolved(int agent) const {
+        return !paths[agent].empty();
+    }
+
+    int getSolvedCount() const {
+        int solved = 0;
+        for (size_t i = 0; i < paths.size(); ++i) solved += !paths[i].empty();
+        return solved;
+    }
+
+    // Time step at which the last agent arrives
+    int getMakespan() const {
+        size_t makespan = 0;
+        for (size_t i = 0; i < paths.size(); ++i) makespan = std::max(makespan, paths[i].size());
+        return makespan ? static_cast<int>(makespan) - 1 : 0;
+    }
+
+    // Sum over solved agents of move and wait costs
+    double getSumOfCosts() const {
+        double total = 0;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            for (size_t t = 1; t < paths[i].size(); ++t) {
+                Cell a = keyToCell(paths[i][t - 1]), b = keyToCell(paths[i][t]);
+                total += a.x != b.x && a.y != b.y ? 1.414 : 1.0;
+            }
+        }
+        return total;
+    }
+
+    // Colliding pairs among the current plans (0 after plan())
+    int countConflicts() const {
+        std::vector<std::pair<int, int> > conflicts;
+        findConflicts(conflicts);
+        return static_cast<int>(conflicts.size());
+    }
+
+    int getGroupCount() const {
+        return static_cast<int>(groups.size());
+    }
+
+    int getMergeRounds() const {
+        return merge_rounds;
+    }
+
+    long long getNodesExpanded() const {
+        long long total = 0;
+        for (size_t w = 0; w < searches.size(); ++w) total += searches[w].expansions;
+        return total;
+    }
+
+    int threadCount() const {
+        return pool.size();
+    }
+};
+
+const int CooperativePlanner::MARGIN;
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef DSTAR_LITE_H
+#define DSTAR_LITE_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "open_list.h"
+
+// D* Lite incremental planner. It searches backwards from the goal and
+// keeps its g/rhs values between calls, so when the robot discovers
+// obstacles only the part of the search tree whose costs actually change
+// is repaired. The movement model matches AStar. The heuristic must be
+// consistent with the 1.414 diagonal cost, such as Chebyshev: Euclidean
+// overestimates long diagonals slightly (sqrt(2) > 1.414), and that is
+// enough to end a repair before the start's cost is correct.
+//
+// Unlike AStar the planner edits the grid it is given: applyChanges()
+// toggles the listed cells before repairing the plan.
+class DStarLite {
+private:
+    struct Key {
+        double k1, k2;
+        bool operator<(const Key& other) const {
+            return k1 < other.k1 || (k1 == other.k1 && k2 < other.k2);
+        }
+    };
+
+    Grid& grid;
+    Heuristic heuristic;
+    std::vector<double> g;
+    std::vector<double> rhs;
+    IndexedHeap<Key, 4> open_list;
+    Cell start;
+    Cell goal;
+    Cell last_start;
+    double km;
+    std::vector<Cell> path;
+    int nodes_expanded;
+
+    static double infinity() {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    // Edge cost, infinite when either end is blocked
+    double cost(const Cell& from, const Cell& to) const {
+        if (grid.isObstacle(from.x, from.y) || grid.isObstacle(to.x, to.y)) return infinity();
+        return (from.x != to.x && from.y != to.y) ? 1.414 : 1.0;
+    }
+
+    Key calculateKey(int key) const {
+        double best = std::min(g[key], rhs[key]);
+        Key result = {best + heuristic(start, keyToCell(key)) + km, best};
+        return result;
+    }
+
+    void updateVertex(int key) {
+        Cell cell = keyToCell(key);
+        if (!(cell == goal)) {
+            double best = infinity();
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    Cell next = {cell.x + dx, cell.y + dy};
+                    if ((dx == 0 && dy == 0) || !grid.isValidCell(next.x, next.y)) continue;
+                    best = std::min(best, cost(cell, next) + g[cellToKey(next)]);
+                }
+            }
+            rhs[key] = best;
+        }
+        bool queued = open_list.contains(key);
+        if (g[key] != rhs[key]) {
+            if (queued) open_list.update(key, calculateKey(key));
+            else open_list.push(key, calculateKey(key));
+        } else if (queued) {
+            open_list.remove(key);
+        }
+    }
+
+    void updateNeighbors(const Cell& cell) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                Cell next = {cell.x + dx, cell.y + dy};
+                if ((dx == 0 && dy == 0) || !grid.isValidCell(next.x, next.y)) continue;
+                updateVertex(cellToKey(next));
+            }
+        }
+    }
+
+    void computeShortestPath() {
+        int start_key = cellToKey(start);
+        while (!open_list.empty() &&
+               (open_list.topPriority() < calculateKey(start_key) || rhs[start_key] != g[start_key])) {
+            Key old_key = open_list.topPriority();
+            int key = open_list.pop();
+            nodes_expanded++;
+            Key new_key = calculateKey(key);
+            if (old_key < new_key) {
+                open_list.push(key, new_key);
+            } else if (g[key] > rhs[key]) {
+                g[key] = rhs[key];
+                updateNeighbors(keyToCell(key));
+            } else {
+                g[key] = infinity();
+                updateVertex(key);
+                updateNeighbors(keyToCell(key));
+            }
+        }
+    }
+
+    // Greedy descent on g from the start
+    bool extractPath() {
+        path.clear();
+        if (rhs[cellToKey(start)] == infinity()) return false;
+        Cell current = start;
+        path.push_back(current);
+        while (!(current == goal)) {
+            Cell best_next = current;
+            double best = infinity();
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    Cell next = {current.x + dx, current.y + dy};
+                    if ((dx == 0 && dy == 0) || !grid.isValidCell(next.x, next.y)) continue;
+                    double value = cost(current, next) + g[cellToKey(next)];
+                    if (value < best) {
+                        best = value;
+                        best_next = next;
+                    }
+                }
+            }
+            if (best == infinity() || path.size() > g.size()) {
+                path.clear();
+                return false;
+            }
+            current = best_next;
+            path.push_back(current);
+        }
+        return true;
+    }
+
+public:
+    DStarLite(Grid& g_, Heuristic h) : grid(g_), heuristic(h), km(0), nodes_expanded(0) {}
+
+    bool findPath() {
+        return findPath(grid.start, grid.goal);
+    }
+
+    // Plans from scratch towards a new goal
+    bool findPath(const Cell& from, const Cell& to) {
+        int num_cells = grid.width * grid.height;
+        start = last_start = from;
+        goal = to;
+        km = 0;
+        nodes_expanded = 0;
+        g.assign(num_cells, infinity());
+        rhs.assign(num_cells, infinity());
+        open_list.reset(num_cells);
+
+        int goal_key = cellToKey(goal);
+        rhs[goal_key] = 0;
+        open_list.push(goal_key, calculateKey(goal_key));
+        computeShortestPath();
+        return extractPath();
+    }
+
+    // The robot has moved; takes effect with the next applyChanges()
+    void moveStart(const Cell& new_start) {
+        start = new_start;
+    }
+
+    // Toggles each listed cell between free and blocked, then repairs the
+    // plan from the current start
+    bool applyChanges(const std::vector<Cell>& toggled) {
+        nodes_expanded = 0;
+        km += heuristic(last_start, start);
+        last_start = start;
+        for (size_t i = 0; i < toggled.size(); ++i) {
+            const Cell& cell = toggled[i];
+            grid.setObstacle(cell.x, cell.y, !grid.isObstacle(cell.x, cell.y));
+        }
+        for (size_t i = 0; i < toggled.size(); ++i) {
+            updateVertex(cellToKey(toggled[i]));
+            updateNeighbors(toggled[i]);
+        }
+        computeShortestPath();
+        return extractPath();
+    }
+
+    int getPathLength() const {
+        return path.size();
+    }
+
+    double getPathCost() const {
+        return path.empty() ? 0 : rhs[cellToKey(start)];
+    }
+
+    // Expansions made by the last findPath() or applyChanges()
+    int getNodesExpanded() const {
+        return nodes_expanded;
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+};
+
+#endif
@@ -0,0 +1,307 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include "grid_generator.h"
+#include "thread_pool.h"
+
+// Many-to-one paths: one shortest-path search from the goal gives every
+// cell its cost to the goal and the direction of its next move, so any
+// number of agents heading for the same goal just follow the directions,
+// O(path length) each. Moves and costs match AStar (8-connected, 1 and
+// 1.414).
+//
+// Costs are kept as integer thousandths, which makes both move costs exact,
+// and the search is Dial's algorithm with buckets one unit (the cheapest
+// move) wide: no cell can improve another cell of its own bucket, so every
+// cell of the current bucket is final and the bucket is settled by all
+// threads at once. Improvements are published with a compare-and-swap on
+// the cell's cost.
+//
+// The field references the grid. After editing obstacles, pass the changed
+// cells to update(): cells whose route ran through a newly blocked cell are
+// reset and searched again, and newly freed cells seed a search that only
+// spreads as far as costs actually drop.
+class FlowField {
+public:
+    static const uint32_t UNREACHABLE = 0xFFFFFFFF;
+    static const int NO_DIRECTION = 8;
+
+private:
+    static const uint32_t UNIT = 1000;
+    // Below this many cells a bucket is settled on the calling thread
+    static const size_t PARALLEL_BUCKET = 1024;
+    static const int DX[8];
+    static const int DY[8];
+    static const uint32_t STEP[8];
+
+    struct Entry {
+        int key;
+        uint32_t cost;
+        bool operator<(const Entry& other) const {
+            return cost < other.cost;
+        }
+    };
+
+    // Cells a worker reached while settling the current bucket, by bucket
+    // offset (+1 or +2)
+    struct WorkerBuckets {
+        std::vector<Entry> ahead[2];
+    };
+
+    const Grid& grid;
+    ThreadPool pool;
+    Cell goal;
+    int num_cells;
+    std::unique_ptr<std::atomic<uint32_t>[]> costs;
+    std::vector<uint8_t> directions;
+    std::vector<Entry> ring[3];
+    std::vector<WorkerBuckets> workers;
+    std::vector<Entry> seeds;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    uint32_t costAt(int key) const {
+        return costs[key].load(std::memory_order_relaxed);
+    }
+
+    // Lowers the cost of key to cost; true if it was higher
+    bool lower(int key, uint32_t cost) {
+        uint32_t current = costs[key].load(std::memory_order_relaxed);
+        while (cost < current) {
+            if (costs[key].compare_exchange_weak(current, cost, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    // Settles entries [begin, end) of bucket `bucket`. Entries whose cell
+    // has since been lowered are stale and skipped; a cell lowered to the
+    // same cost twice is pushed only once, so each cell settles once.
+    void settle(int worker, const Entry* begin, const Entry* end, uint32_t bucket) {
+        WorkerBuckets& local = workers[worker];
+        for (const Entry* entry = begin; entry != end; ++entry) {
+            if (costAt(entry->key) != entry->cost) continue;
+            Cell cell = keyToCell(entry->key);
+
+            // The parent is final by now: it lies in an earlier bucket
+            int direction = NO_DIRECTION;
+            for (int d = 0; d < 8 && entry->cost > 0; ++d) {
+                int x = cell.x + DX[d], y = cell.y + DY[d];
+                if (grid.isObstacle(x, y)) continue;
+                uint32_t neighbor_cost = costAt(y * grid.width + x);
+                if (neighbor_cost != UNREACHABLE && neighbor_cost + STEP[d] == entry->cost) {
+                    direction = d;
+                    break;
+                }
+            }
+            directions[entry->key] = direction;
+
+            for (int d = 0; d < 8; ++d) {
+                int x = cell.x + DX[d], y = cell.y + DY[d];
+                if (grid.isObstacle(x, y)) continue;
+                int key = y * grid.width + x;
+                uint32_t cost = entry->cost + STEP[d];
+                if (lower(key, cost)) {
+                    Entry reached = {key, cost};
+                    local.ahead[cost / UNIT - bucket - 1].push_back(reached);
+                }
+            }
+        }
+    }
+
+    // Dial's algorithm from the current seeds, which must be sorted
+    void run() {
+        size_t next_seed = 0;
+        uint32_t bucket = 0;
+        while (true) {
+            if (ring[0].empty() && ring[1].empty() && ring[2].empty()) {
+                if (next_seed == seeds.size()) break;
+                bucket = seeds[next_seed].cost / UNIT;
+            }
+            while (next_seed < seeds.size() && seeds[next_seed].cost / UNIT <= bucket + 2) {
+                ring[(seeds[next_seed].cost / UNIT) % 3].push_back(seeds[next_seed]);
+                next_seed++;
+            }
+
+            std::vector<Entry>& current = ring[bucket % 3];
+            if (!current.empty()) {
+                const Entry* entries = current.data();
+                size_t count = current.size();
+                if (count < PARALLEL_BUCKET || pool.size() == 1) {
+                    settle(0, entries, entries + count, bucket);
+                } else {
+                    int num_workers = pool.size();
+                    pool.run([&](int worker) {
+                        settle(worker, entries + count * worker / num_workers,
+                               entries + count * (worker + 1) / num_workers, bucket);
+                    });
+                }
+                current.clear();
+                for (size_t w = 0; w < workers.size(); ++w) {
+                    for (int offset = 0; offset < 2; ++offset) {
+                        std::vector<Entry>& reached = workers[w].ahead[offset];
+                        std::vector<Entry>& target = ring[(bucket + 1 + offset) % 3];
+                        target.insert(target.end(), reached.begin(), reached.end());
+                        reached.clear();
+                    }
+                }
+            }
+            bucket++;
+        }
+        seeds.clear();
+    }
+
+    void seedFromNeighbors(int key) {
+        Cell cell = keyToCell(key);
+        uint32_t best = UNREACHABLE;
+        for (int d = 0; d < 8; ++d) {
+            int x = cell.x + DX[d], y = cell.y + DY[d];
+            if (grid.isObstacle(x, y)) continue;
+            uint32_t neighbor_cost = costAt(y * grid.width + x);
+            if (neighbor_cost != UNREACHABLE) best = std::min(best, neighbor_cost + STEP[d]);
+        }
+        if (best != UNREACHABLE && best < costAt(key)) {
+            costs[key].store(best, std::memory_order_relaxed);
+            Entry seed = {key, best};
+            seeds.push_back(seed);
+        }
+    }
+
+public:
+    // num_threads <= 0 uses every hardware thread
+    FlowField(const Grid& g, int num_threads = 0) : grid(g), pool(num_threads), num_cells(0), workers(pool.size()) {
+        goal.x = goal.y = 0;
+    }
+
+    int threadCount() const {
+        return pool.size();
+    }
+
+    void build() {
+        build(grid.goal);
+    }
+
+    // Computes the field towards goal from scratch
+    void build(const Cell& target) {
+        goal = target;
+        if (num_cells != grid.width * grid.height) {
+            num_cells = grid.width * grid.height;
+            costs.reset(new std::atomic<uint32_t>[num_cells]);
+        }
+        for (int key = 0; key < num_cells; ++key) costs[key].store(UNREACHABLE, std::memory_order_relaxed);
+        directions.assign(num_cells, NO_DIRECTION);
+        if (grid.isObstacle(goal.x, goal.y)) return;
+        int goal_key = cellToKey(goal);
+        costs[goal_key].store(0, std::memory_order_relaxed);
+        Entry seed = {goal_key, 0};
+        seeds.assign(1, seed);
+        run();
+    }
+
+    // Repairs the field after the obstacle state of `changed` cells flipped
+    void update(const std::vector<Cell>& changed) {
+        for (size_t i = 0; i < changed.size(); ++i) {
+            if (changed[i] == goal) {
+                build(goal);
+                return;
+            }
+        }
+
+        // Cells routed through a newly blocked cell lose their cost
+        std::vector<int> invalid;
+        for (size_t i = 0; i < changed.size(); ++i) {
+            int key = cellToKey(changed[i]);
+            if (grid.isObstacle(changed[i].x, changed[i].y) && costAt(key) != UNREACHABLE) {
+                costs[key].store(UNREACHABLE, std::memory_order_relaxed);
+                invalid.push_back(key);
+            }
+        }
+        for (size_t i = 0; i < invalid.size(); ++i) {
+            Cell cell = keyToCell(invalid[i]);
+            directions[invalid[i]] = NO_DIRECTION;
+            for (int d = 0; d < 8; ++d) {
+                int x = cell.x + DX[d], y = cell.y + DY[d];
+                if (grid.isObstacle(x, y)) continue;
+                int key = y * grid.width + x;
+                // A child steps back in the opposite direction (d ^ 1)
+                if (costAt(key) != UNREACHABLE && directions[key] == (d ^ 1)) {
+                    costs[key].store(UNREACHABLE, std::memory_order_relaxed);
+                    invalid.push_back(key);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < invalid.size(); ++i) {
+            Cell cell = keyToCell(invalid[i]);
+            if (!grid.isObstacle(cell.x, cell.y)) seedFromNeighbors(invalid[i]);
+        }
+        for (size_t i = 0; i < changed.size(); ++i) {
+            if (!grid.isObstacle(changed[i].x, changed[i].y)) seedFromNeighbors(cellToKey(changed[i]));
+        }
+        std::sort(seeds.begin(), seeds.end());
+        run();
+    }
+
+    const Cell& getGoal() const {
+        return goal;
+    }
+
+    bool isReachable(const Cell& cell) const {
+        return costAt(cellToKey(cell)) != UNREACHABLE;
+    }
+
+    double getCost(const Cell& cell) const {
+        return costAt(cellToKey(cell)) / static_cast<double>(UNIT);
+    }
+
+    // Index into the move table, NO_DIRECTION at the goal or when unreachable
+    int getDirection(const Cell& cell) const {
+        return directions[cellToKey(cell)];
+    }
+
+    Cell next(const Cell& cell) const {
+        int d = directions[cellToKey(cell)];
+        if (d == NO_DIRECTION) return cell;
+        Cell step = {cell.x + DX[d], cell.y + DY[d]};
+        return step;
+    }
+
+    // Path from `from` to the goal, both included; false if unreachable
+    bool followPath(const Cell& from, std::vector<Cell>& path) const {
+        path.clear();
+        if (!isReachable(from)) return false;
+        Cell cell = from;
+        path.push_back(cell);
+        while (!(cell == goal)) {
+            cell = next(cell);
+            path.push_back(cell);
+        }
+        return true;
+    }
+
+    size_t memoryBytes() const {
+        return static_cast<size_t>(num_cells) * (sizeof(uint32_t) + sizeof(uint8_t));
+    }
+};
+
+// Opposite directions differ only in the lowest bit (d ^ 1)
+const int FlowField::DX[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+const int FlowField::DY[8] = {0, 0, 1, -1, 1, -1, -1, 1};
+const uint32_t FlowField::STEP[8] = {1000, 1000, 1000, 1000, 1414, 1414, 1414, 1414};
+const uint32_t FlowField::UNREACHABLE;
+const int FlowField::NO_DIRECTION;
+const uint32_t FlowField::UNIT;
+const size_t FlowField::PARALLEL_BUCKET;
+
+#endif
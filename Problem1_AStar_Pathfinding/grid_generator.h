@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <random>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
 
 struct Cell {
     int x, y;
@@ -11,51 +14,128 @@ struct Cell {
     }
 };
 
+// Obstacles are stored as one contiguous bitset. Every row starts on a
+// 64-bit word boundary and the map is surrounded by a one-cell border that
+// always reads as blocked, so neighbors of any in-bounds cell can be tested
+// without a bounds check.
 struct Grid {
-    std::vector<std::vector<bool>> obstacles;
     Cell start;
     Cell goal;
     int width, height;
-    
+
     Grid(int w, int h) : width(w), height(h) {
-        obstacles.resize(height, std::vector<bool>(width, false));
+        // One spare word per row lets rowBits() read an unaligned window
+        // without checking for the end of the row.
+        stride = (width + 2 + 63) / 64 + 1;
+        bits.assign(static_cast<size_t>(stride) * (height + 2), ~uint64_t(0));
+        for (int x = 0; x < width; ++x) {
+            setObstacle(x, 0, false);
+        }
+        for (int y = 1; y < height; ++y) {
+            std::copy(rowWords(0), rowWords(0) + stride, &bits[static_cast<size_t>(y + 1) * stride]);
+        }
     }
-    
+
     bool isValidCell(int x, int y) const {
         return x >= 0 && x < width && y >= 0 && y < height;
     }
-    
+
+    // Valid for -1 <= x <= width and -1 <= y <= height; the border is blocked.
     bool isObstacle(int x, int y) const {
-        return isValidCell(x, y) && obstacles[y][x];
+        size_t bit = static_cast<size_t>(x + 1);
+        return (rowWords(y)[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    void setObstacle(int x, int y, bool blocked) {
+        size_t bit = static_cast<size_t>(x + 1);
+        uint64_t mask = uint64_t(1) << (bit & 63);
+        uint64_t& word = bits[static_cast<size_t>(y + 1) * stride + (bit >> 6)];
+        word = blocked ? (word | mask) : (word & ~mask);
     }
+
+    // Obstacle bits of the 64 cells x, x+1, ..., x+63 of row y (bit 0 is x),
+    // for -1 <= x <= width. Cells past the right edge read as blocked.
+    uint64_t rowBits(int y, int x) const {
+        const uint64_t* row = rowWords(y);
+        size_t bit = static_cast<size_t>(x + 1);
+        size_t word = bit >> 6;
+        unsigned shift = bit & 63;
+        if (shift == 0) return row[word];
+        return (row[word] >> shift) | (row[word + 1] << (64 - shift));
+    }
+
+    // Sets cells x, x+1, ..., x+63 of row y from value (bit 0 is x), for x
+    // a multiple of 64, calling with x ascending. Cells past the right edge
+    // stay blocked whatever value holds.
+    void setRowBits(int y, int x, uint64_t value) {
+        if (width - x < 64) value |= ~uint64_t(0) << (width - x);
+        uint64_t* row = &bits[static_cast<size_t>(y + 1) * stride];
+        size_t word = static_cast<size_t>(x) >> 6;
+        row[word] = (row[word] & 1) | (value << 1);
+        row[word + 1] = (row[word + 1] & ~uint64_t(1)) | (value >> 63);
+    }
+
+    // Raw padded row y (-1 <= y <= height): bit i holds column i - 1.
+    const uint64_t* rowWords(int y) const {
+        return &bits[static_cast<size_t>(y + 1) * stride];
+    }
+
+    int wordsPerRow() const {
+        return stride;
+    }
+
+    size_t countObstacles() const {
+        size_t count = 0;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; x += 64) {
+                uint64_t word = rowBits(y, x);
+                if (width - x < 64) word &= (uint64_t(1) << (width - x)) - 1;
+                count += __builtin_popcountll(word);
+            }
+        }
+        return count;
+    }
+
+    size_t memoryBytes() const {
+        return bits.size() * sizeof(uint64_t);
+    }
+
+private:
+    int stride;
+    std::vector<uint64_t> bits;
 };
 
-Grid generateRandomGrid(int width, int height, double obstacle_ratio) {
+// The same seed always produces the same grid, start and goal
+Grid generateRandomGrid(int width, int height, double obstacle_ratio, uint32_t seed) {
     Grid grid(width, height);
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
+
+    std::mt19937 gen(seed);
     std::uniform_real_distribution<> dis(0.0, 1.0);
-    
+
     // Generate obstacles
     for (int y = 0; y < height; ++y) {
         for (int x = 0; x < width; ++x) {
-            grid.obstacles[y][x] = (dis(gen) < obstacle_ratio);
+            grid.setObstacle(x, y, dis(gen) < obstacle_ratio);
         }
     }
-    
+
     // Generate start and goal positions
     std::uniform_int_distribution<> x_dist(0, width - 1);
     std::uniform_int_distribution<> y_dist(0, height - 1);
-    
+
     do {
         grid.start = {x_dist(gen), y_dist(gen)};
         grid.goal = {x_dist(gen), y_dist(gen)};
-    } while (grid.isObstacle(grid.start.x, grid.start.y) || 
+    } while (grid.isObstacle(grid.start.x, grid.start.y) ||
              grid.isObstacle(grid.goal.x, grid.goal.y) ||
              (grid.start.x == grid.goal.x && grid.start.y == grid.goal.y));
-    
+
     return grid;
 }
 
-#endif
\ No newline at end of file
+Grid generateRandomGrid(int width, int height, double obstacle_ratio) {
+    std::random_device rd;
+    return generateRandomGrid(width, height, obstacle_ratio, rd());
+}
+
+#endif
@@ -0,0 +1,410 @@
+#ifndef HDA_STAR_H
+#define HDA_STAR_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "neighborhoods.h"
+#include "thread_pool.h"
+
+// Hash-distributed A* (HDA*) for one query on a map too large for a single
+// core. Every cell belongs to one worker, chosen by hashing its 4x4 block:
+// blocks scatter evenly over the workers while most neighbours still share
+// an owner. A worker keeps the g values of its cells and an open list of
+// them; a node generated for a cell owned elsewhere is sent to the owner
+// in a batch through that worker's lock-free inbox (many senders, one
+// receiver).
+//
+// The first path to reach the goal sets an incumbent cost shared by all
+// workers, and nodes with f at or above it are dropped. The search ends
+// when no worker has a node left below the incumbent and no batch is in
+// flight: a single counter holds the workers still busy plus the batches
+// sent and not yet processed, and only reaches zero once nothing can
+// change any more. With an admissible heuristic the incumbent is then
+// optimal. The path is followed back through the owners' parent entries.
+template <class HeuristicT = Octile, class Neighborhood = EightConnected, class MapT = Grid>
+class BasicParallelAStar {
+private:
+    static const int BATCH_SIZE = 128;
+    static const int EXPANSIONS_PER_POLL = 64; // between inbox checks
+    static const int BLOCK_SHIFT = 2;          // 4x4 blocks
+
+    struct Message {
+        double g;
+        int cell;
+        int parent;
+    };
+
+    struct Batch {
+        Batch* next;
+        int count;
+        Message messages[BATCH_SIZE];
+    };
+
+    // Senders push with a CAS on head; the owner takes the whole list with
+    // one exchange, so no node is ever popped from under a sender (no ABA)
+    struct Inbox {
+        std::atomic<Batch*> head;
+        char padding[64 - sizeof(std::atomic<Batch*>)];
+    };
+
+    struct Entry {
+        double g;
+        int cell; // -1 when empty
+        int parent;
+    };
+
+    // Cell -> best g and parent for the cells one worker owns; linear
+    // probing, doubled at half load
+    class CellTable {
+    private:
+        std::vector<Entry> slots;
+        size_t used;
+        int shift;
+
+        size_t home(int cell) const {
+            return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(cell)) * 0x9E3779B97F4A7C15ULL) >>
+                                       shift);
+        }
+
+        void grow() {
+            std::vector<Entry> old;
+            old.swap(slots);
+            Entry empty = {0, -1, -1};
+            slots.assign(old.size() * 2, empty);
+            shift--;
+            for (size_t i = 0; i < old.size(); ++i) {
+                if (old[i].cell < 0) continue;
+                size_t mask = slots.size() - 1;
+                size_t j = home(old[i].cell);
+                while (slots[j].cell >= 0) j = (j + 1) & mask;
+                slots[j] = old[i];
+            }
+        }
+
+    public:
+        CellTable() : used(0), shift(64 - 10) {
+            Entry empty = {0, -1, -1};
+            slots.assign(1024, empty);
+        }
+
+        void clear() {
+            Entry empty = {0, -1, -1};
+            std::fill(slots.begin(), slots.end(), empty);
+            used = 0;
+        }
+
+        // The entry for cell, added with an infinite g if missing
+        Entry& at(int cell) {
+            if (2 * (used + 1) > slots.size()) grow();
+            size_t mask = slots.size() - 1;
+            size_t i = home(cell);
+            for (; slots[i].cell >= 0; i = (i + 1) & mask) {
+                if (slots[i].cell == cell) return slots[i];
+            }
+            slots[i].cell = cell;
+            slots[i].g = std::numeric_limits<double>::infinity();
+            slots[i].parent = -1;
+            used++;
+            return slots[i];
+        }
+
+        const Entry* find(int cell) const {
+            size_t mask = slots.size() - 1;
+            for (size_t i = home(cell); slots[i].cell >= 0; i = (i + 1) & mask) {
+                if (slots[i].cell == cell) return &slots[i];
+            }
+            return nullptr;
+        }
+
+        size_t size() const {
+            return used;
+        }
+
+        size_t memoryBytes() const {
+            return slots.size() * sizeof(Entry);
+        }
+    };
+
+    struct OpenEntry {
+        double f;
+        double g;
+        int cell;
+
+        // Heap order: lowest f on top, then highest g
+        bool operator<(const OpenEntry& other) const {
+            return f > other.f || (f == other.f && g < other.g);
+        }
+    };
+
+    struct Worker {
+        CellTable table;
+        std::vector<OpenEntry> open;
+        std::vector<Batch*> outbox; // partly filled batch per destination
+        std::vector<Batch*> spare;  // received batches kept for sending
+        long long expanded;
+        long long sent;
+    };
+
+    const MapT& grid;
+    HeuristicT heuristic;
+    ThreadPool pool;
+    std::vector<std::unique_ptr<Worker> > workers;
+    std::unique_ptr<Inbox[]> inboxes;
+    std::atomic<long long> pending; // busy workers plus batches in flight
+    std::atomic<double> incumbent;
+
+    Cell goal;
+    int goal_key;
+    std::vector<Cell> path;
+    double path_cost;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    int owner(const Cell& cell) const {
+        uint64_t block = (static_cast<uint64_t>(cell.y >> BLOCK_SHIFT) << 32) | static_cast<uint32_t>(cell.x >> BLOCK_SHIFT);
+        uint64_t hash = (block * 0x9E3779B97F4A7C15ULL) >> 32;
+        return static_cast<int>((hash * static_cast<uint64_t>(pool.size())) >> 32);
+    }
+
+    void lowerIncumbent(double cost) {
+        double current = incumbent.load();
+        while (cost < current && !incumbent.compare_exchange_weak(current, cost)) {
+        }
+    }
+
+    // Takes in a node for one of this worker's cells
+    void relax(Worker& me, const Message& message) {
+        Entry& entry = me.table.at(message.cell);
+        if (message.g >= entry.g) return;
+        entry.g = message.g;
+        entry.parent = message.parent;
+        if (message.cell == goal_key) {
+            lowerIncumbent(message.g);
+            return;
+        }
+        OpenEntry node = {message.g + heuristic(keyToCell(message.cell), goal), message.g, message.cell};
+        if (node.f >= incumbent.load(std::memory_order_relaxed)) return;
+        me.open.push_back(node);
+        std::push_heap(me.open.begin(), me.open.end());
+    }
+
+    void send(Worker& me, int destination) {
+        Batch* batch = me.outbox[destination];
+        me.outbox[destination] = nullptr;
+        me.sent += batch->count;
+        pending.fetch_add(1);
+        std::atomic<Batch*>& head = inboxes[destination].head;
+        batch->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    void post(Worker& me, int destination, const Message& message) {
+        Batch*& batch = me.outbox[destination];
+        if (!batch) {
+            if (me.spare.empty()) {
+                batch = new Batch();
+            } else {
+                batch = me.spare.back();
+                me.spare.pop_back();
+            }
+            batch->count = 0;
+        }
+        batch->messages[batch->count++] = message;
+        if (batch->count == BATCH_SIZE) send(me, destination);
+    }
+
+    void flush(Worker& me) {
+        for (size_t i = 0; i < me.outbox.size(); ++i) {
+            if (me.outbox[i]) send(me, static_cast<int>(i));
+        }
+    }
+
+    // Pops stale entries and gives up the whole list once its best f
+    // reaches the incumbent; false when nothing is left to expand
+    bool nextOpen(Worker& me, OpenEntry& node) {
+        while (!me.open.empty()) {
+            node = me.open.front();
+            if (node.f >= incumbent.load(std::memory_order_relaxed)) {
+                me.open.clear();
+                return false;
+            }
+            std::pop_heap(me.open.begin(), me.open.end());
+            me.open.pop_back();
+            if (node.g <= me.table.find(node.cell)->g) return true;
+        }
+        return false;
+    }
+
+    void expand(int index, Worker& me, const OpenEntry& node) {
+        me.expanded++;
+        Cell neighbors[Neighborhood::MAX_NEIGHBORS];
+        double costs[Neighborhood::MAX_NEIGHBORS];
+        int count = Neighborhood::expand(grid, keyToCell(node.cell), neighbors, costs);
+        double bound = incumbent.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i) {
+            Message message = {node.g + costs[i], cellToKey(neighbors[i]), node.cell};
+            if (message.g + heuristic(neighbors[i], goal) >= bound) continue;
+            int destination = owner(neighbors[i]);
+            if (destination == index) relax(me, message);
+            else post(me, destination, message);
+        }
+    }
+
+    void work(int index) {
+        Worker& me = *workers[index];
+        bool busy = true;
+        while (true) {
+            Batch* batch = inboxes[index].head.exchange(nullptr, std::memory_order_acquire);
+            if (batch && !busy) {
+                // Counted before the batches are, so pending cannot touch zero
+                busy = true;
+                pending.fetch_add(1);
+            }
+            while (batch) {
+                Batch* next = batch->next;
+                for (int i = 0; i < batch->count; ++i) relax(me, batch->messages[i]);
+                me.spare.push_back(batch);
+                pending.fetch_sub(1);
+                batch = next;
+            }
+
+            OpenEntry node;
+            int expanded = 0;
+            while (expanded < EXPANSIONS_PER_POLL && nextOpen(me, node)) {
+                expand(index, me, node);
+                expanded++;
+            }
+            if (expanded == EXPANSIONS_PER_POLL) {
+                // Keep the others fed rather than waiting for full batches
+                flush(me);
+                continue;
+            }
+
+            // Out of work: pass on what is left, then wait for more or the end
+            flush(me);
+            if (busy) {
+                busy = false;
+                pending.fetch_sub(1);
+            }
+            if (pending.load() == 0) return;
+            if (!inboxes[index].head.load(std::memory_order_relaxed)) std::this_thread::yield();
+        }
+    }
+
+    void reconstructPath() {
+        path.clear();
+        for (int key = goal_key; key != -1;) {
+            Cell cell = keyToCell(key);
+            path.push_back(cell);
+            key = workers[owner(cell)]->table.find(key)->parent;
+        }
+        std::reverse(path.begin(), path.end());
+    }
+
+public:
+    // num_threads <= 0 uses every hardware thread
+    explicit BasicParallelAStar(const MapT& g, int num_threads = 0, HeuristicT h = HeuristicT())
+        : grid(g), heuristic(h), pool(num_threads), inboxes(new Inbox[pool.size()]), pending(0), incumbent(0),
+          goal_key(-1), path_cost(0) {
+        for (int i = 0; i < pool.size(); ++i) {
+            workers.push_back(std::unique_ptr<Worker>(new Worker()));
+            workers[i]->outbox.assign(pool.size(), nullptr);
+            inboxes[i].head.store(nullptr);
+        }
+    }
+
+    ~BasicParallelAStar() {
+        for (size_t i = 0; i < workers.size(); ++i) {
+            for (size_t j = 0; j < workers[i]->spare.size(); ++j) delete workers[i]->spare[j];
+        }
+    }
+
+    int threadCount() const {
+        return pool.size();
+    }
+
+    bool findPath() {
+        return findPath(grid.start, grid.goal);
+    }
+
+    bool findPath(const Cell& start, const Cell& target) {
+        goal = target;
+        goal_key = cellToKey(goal);
+        path.clear();
+        path_cost = 0;
+        incumbent.store(std::numeric_limits<double>::infinity());
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i]->table.clear();
+            workers[i]->open.clear();
+            workers[i]->expanded = 0;
+            workers[i]->sent = 0;
+        }
+
+        Message first = {0, cellToKey(start), -1};
+        relax(*workers[owner(start)], first);
+        // Every worker starts busy and checks its inbox before going idle
+        pending.store(pool.size());
+        pool.run([this](int worker) { work(worker); });
+
+        double cost = incumbent.load();
+        if (cost == std::numeric_limits<double>::infinity()) return false;
+        path_cost = cost;
+        reconstructPath();
+        return true;
+    }
+
+    int getPathLength() const {
+        return path.size();
+    }
+
+    double getPathCost() const {
+        return path_cost;
+    }
+
+    // Summed over the workers
+    int getNodesExpanded() const {
+        long long total = 0;
+        for (size_t i = 0; i < workers.size(); ++i) total += workers[i]->expanded;
+        return static_cast<int>(total);
+    }
+
+    // Nodes handed to another worker during the last query
+    long long getNodesSent() const {
+        long long total = 0;
+        for (size_t i = 0; i < workers.size(); ++i) total += workers[i]->sent;
+        return total;
+    }
+
+    // Cells in the busiest and the least busy worker's table, for load balance
+    void getTableSizes(size_t& smallest, size_t& largest) const {
+        smallest = std::numeric_limits<size_t>::max();
+        largest = 0;
+        for (size_t i = 0; i < workers.size(); ++i) {
+            smallest = std::min(smallest, workers[i]->table.size());
+            largest = std::max(largest, workers[i]->table.size());
+        }
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+};
+
+typedef BasicParallelAStar<> ParallelAStar;
+
+#endif
@@ -1,20 +1,80 @@
 #ifndef HEURISTICS_H
 #define HEURISTICS_H
 
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
 #include "grid_generator.h"
 
 typedef double (*HeuristicFunction)(const Cell&, const Cell&);
 
+// A heuristic chosen at runtime: either a plain distance function or a
+// function bound to precomputed data such as a landmark table. Plain
+// functions convert implicitly, so solvers accept either.
+class Heuristic {
+public:
+    typedef double (*BoundFunction)(const void* context, const Cell&, const Cell&);
+
+    Heuristic(HeuristicFunction function) : plain(function), bound(nullptr), context(nullptr) {}
+
+    Heuristic(BoundFunction function, const void* data) : plain(nullptr), bound(function), context(data) {}
+
+    double operator()(const Cell& a, const Cell& b) const {
+        return plain ? plain(a, b) : bound(context, a, b);
+    }
+
+private:
+    HeuristicFunction plain;
+    BoundFunction bound;
+    const void* context;
+};
+
+// Heuristics as function objects. A solver templated on one of these
+// calls it directly, so the estimate is inlined into the search loop.
+struct Manhattan {
+    double operator()(const Cell& a, const Cell& b) const {
+        return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+    }
+};
+
+struct Euclidean {
+    double operator()(const Cell& a, const Cell& b) const {
+        double dx = a.x - b.x;
+        double dy = a.y - b.y;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+};
+
+struct Chebyshev {
+    double operator()(const Cell& a, const Cell& b) const {
+        return std::max(std::abs(a.x - b.x), std::abs(a.y - b.y));
+    }
+};
+
+// Exact obstacle-free cost of the 8-connected moves (1 straight, 1.414
+// diagonal), so the tightest admissible estimate for that model
+struct Octile {
+    double operator()(const Cell& a, const Cell& b) const {
+        int dx = std::abs(a.x - b.x);
+        int dy = std::abs(a.y - b.y);
+        return std::max(dx, dy) + 0.414 * std::min(dx, dy);
+    }
+};
+
 double manhattanDistance(const Cell& a, const Cell& b) {
-    return abs(a.x - b.x) + abs(a.y - b.y);
+    return Manhattan()(a, b);
 }
 
 double euclideanDistance(const Cell& a, const Cell& b) {
-    return sqrt(pow(a.x - b.x, 2) + pow(a.y - b.y, 2));
+    return Euclidean()(a, b);
 }
 
 double chebyshevDistance(const Cell& a, const Cell& b) {
-    return std::max(abs(a.x - b.x), abs(a.y - b.y));
+    return Chebyshev()(a, b);
+}
+
+double octileDistance(const Cell& a, const Cell& b) {
+    return Octile()(a, b);
 }
 
-#endif
\ No newline at end of file
+#endif
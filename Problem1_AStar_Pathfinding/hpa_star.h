@@ -0,0 +1,505 @@
+#ifndef HPA_STAR_H
+#define HPA_STAR_H
+
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include <algorithm>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "open_list.h"
+#include "astar.h"
+
+// Hierarchical pathfinding (HPA*). The grid is cut into square clusters.
+// Wherever two neighbouring clusters share a free stretch of border, an
+// entrance is placed (one transition in the middle, or one at each end of
+// long stretches). Diagonal squeezes across a border or a cluster corner,
+// which no straight transition can stand in for, get a transition of
+// their own. Entrance cells become abstract nodes, linked across borders
+// by their transitions and inside their cluster by the shortest path that
+// stays within it. A query searches this small abstract graph and then
+// refines consecutive abstract nodes into grid paths with AStar.
+//
+// Paths are near-optimal: the abstract graph only crosses borders at
+// entrances. After obstacles change, updateObstacles() rebuilds the
+// entrances and distances of the clusters touched by the change only.
+class HierarchicalAStar {
+private:
+    static const int MAX_SINGLE_ENTRANCE = 6;
+
+    // Borders owned by a cluster: to its right neighbour, to its lower
+    // neighbour, and the corner shared with its lower-right neighbours
+    enum BorderKind { RIGHT = 0, LOWER = 1, CORNER = 2 };
+
+    struct Transition {
+        int first;   // cell keys on either side of the border
+        int second;
+        double cost;
+    };
+
+    struct Cluster {
+        int x0, y0, x1, y1;           // cell bounds, [x0, x1) x [y0, y1)
+        std::vector<int> nodes;       // cell keys of entrance nodes
+        std::vector<double> distances; // nodes.size()^2, infinity if unreachable
+    };
+
+    const Grid& grid;
+    Heuristic heuristic;
+    int cluster_size;
+    int clusters_x, clusters_y;
+    std::vector<Cluster> clusters;
+    std::vector<std::vector<Transition> > borders[3];      // [kind][owning cluster]
+    std::unordered_map<int, int> node_index;               // key -> index in its cluster
+    std::unordered_map<int, std::vector<Transition> > crossings; // key -> transitions from it
+
+    // Cluster-local Dijkstra scratch
+    std::vector<double> local_distances;
+    IndexedHeap<double, 2> local_open;
+
+    // Abstract search state, rebuilt per query
+    std::unordered_map<int, int> abstract_slots;  // key -> slot
+    std::vector<int> abstract_keys;
+    std::vector<double> abstract_g;
+    std::vector<int> abstract_parent;              // slot, -1 for the start
+    IndexedHeap<double, 4> abstract_open;
+    std::vector<double> start_distances;
+    std::vector<double> goal_distances;
+    double start_goal_distance;
+
+    AStar refiner;
+    std::vector<int> abstract_path;
+    size_t refined_segments;
+    std::vector<Cell> path;
+    double path_cost;
+    double abstract_cost;
+    int nodes_expanded;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    int clusterOf(const Cell& cell) const {
+        return (cell.y / cluster_size) * clusters_x + cell.x / cluster_size;
+    }
+
+    bool isFree(int x, int y) const {
+        return !grid.isObstacle(x, y);
+    }
+
+    void addTransition(std::vector<Transition>& transitions, int x0, int y0, int x1, int y1) {
+        Cell first = {x0, y0};
+        Cell second = {x1, y1};
+        Transition transition = {cellToKey(first), cellToKey(second), (x0 != x1 && y0 != y1) ? 1.414 : 1.0};
+        transitions.push_back(transition);
+    }
+
+    // Scans the border between cluster c and its right (or lower)
+    // neighbour for free stretches and places transitions on them.
+    void buildBorder(int c, bool right) {
+        std::vector<Transition>& transitions = borders[right ? RIGHT : LOWER][c];
+        transitions.clear();
+        const Cluster& cluster = clusters[c];
+        if (right ? cluster.x1 >= grid.width : cluster.y1 >= grid.height) return;
+        int length = right ? cluster.y1 - cluster.y0 : cluster.x1 - cluster.x0;
+
+        // Position i on the near side is (ax(i), ay(i)), across it is (bx(i), by(i))
+        int ax = right ? cluster.x1 - 1 : cluster.x0, ay = right ? cluster.y0 : cluster.y1 - 1;
+        int step_x = right ? 0 : 1, step_y = right ? 1 : 0;
+        int across_x = right ? 1 : 0, across_y = right ? 0 : 1;
+
+        int run_start = -1;
+        for (int i = 0; i <= length; ++i) {
+            int x = ax + step_x * i, y = ay + step_y * i;
+            bool near_free = i < length && isFree(x, y);
+            bool far_free = i < length && isFree(x + across_x, y + across_y);
+            if (near_free && far_free && run_start == -1) run_start = i;
+            if (!(near_free && far_free) && run_start != -1) {
+                int run_end = i - 1;
+                int picks[2] = {(run_start + run_end) / 2, -1};
+                if (run_end - run_start + 1 >= MAX_SINGLE_ENTRANCE) {
+                    picks[0] = run_start;
+                    picks[1] = run_end;
+                }
+                for (int p = 0; p < 2 && picks[p] != -1; ++p) {
+                    int px = ax + step_x * picks[p], py = ay + step_y * picks[p];
+                    addTransition(transitions, px, py, px + across_x, py + across_y);
+                }
+                run_start = -1;
+            }
+
+            // Diagonal squeeze between i and i + 1 with no straight alternative
+            if (i + 1 < length) {
+                int nx = x + step_x, ny = y + step_y;
+                bool next_near = isFree(nx, ny), next_far = isFree(nx + across_x, ny + across_y);
+                if (near_free && next_far && !next_near && !far_free) {
+                    addTransition(transitions, x, y, nx + across_x, ny + across_y);
+                }
+                if (next_near && far_free && !near_free && !next_far) {
+                    addTransition(transitions, nx, ny, x + across_x, y + across_y);
+                }
+            }
+        }
+    }
+
+    // Diagonal moves through the corner cluster c shares with its right,
+    // lower and lower-right neighbours, where no detour over a straight
+    // border crossing exists
+    void buildCorner(int c) {
+        std::vector<Transition>& transitions = borders[CORNER][c];
+        transitions.clear();
+        const Cluster& cluster = clusters[c];
+        if (cluster.x1 >= grid.width || cluster.y1 >= grid.height) return;
+        int x = cluster.x1 - 1, y = cluster.y1 - 1;
+        bool here = isFree(x, y), diagonal = isFree(x + 1, y + 1);
+        bool right = isFree(x + 1, y), below = isFree(x, y + 1);
+        if (here && diagonal && !right && !below) addTransition(transitions, x, y, x + 1, y + 1);
+        if (right && below && !here && !diagonal) addTransition(transitions, x + 1, y, x, y + 1);
+    }
+
+    void buildBorders(int c) {
+        buildBorder(c, true);
+        buildBorder(c, false);
+        buildCorner(c);
+    }
+
+    // Shortest distances from `from` to every cell of cluster c, moving
+    // only inside the cluster; results in local_distances.
+    void clusterDijkstra(int c, const Cell& from) {
+        const Cluster& cluster = clusters[c];
+        int w = cluster.x1 - cluster.x0, h = cluster.y1 - cluster.y0;
+        local_distances.assign(w * h, std::numeric_limits<double>::infinity());
+        local_open.reset(w * h);
+
+        int from_local = (from.y - cluster.y0) * w + (from.x - cluster.x0);
+        local_distances[from_local] = 0;
+        local_open.push(from_local, 0);
+        while (!local_open.empty()) {
+            int current = local_open.pop();
+            int cx = current % w, cy = current / w;
+            double current_d = local_distances[current];
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int nx = cx + dx, ny = cy + dy;
+                    if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= w || ny >= h) continue;
+                    if (!isFree(cluster.x0 + nx, cluster.y0 + ny)) continue;
+                    double d = current_d + (dx != 0 && dy != 0 ? 1.414 : 1.0);
+                    int next = ny * w + nx;
+                    if (d < local_distances[next]) {
+                        bool queued = local_open.contains(next);
+                        local_distances[next] = d;
+                        if (queued) local_open.decrease(next, d);
+                        else local_open.push(next, d);
+                    }
+                }
+            }
+        }
+    }
+
+    double localDistance(int c, const Cell& cell) const {
+        const Cluster& cluster = clusters[c];
+        return local_distances[(cell.y - cluster.y0) * (cluster.x1 - cluster.x0) + (cell.x - cluster.x0)];
+    }
+
+    void addTransitionNodes(const std::vector<Transition>& transitions, int c) {
+        Cluster& cluster = clusters[c];
+        for (size_t i = 0; i < transitions.size(); ++i) {
+            int ends[2] = {transitions[i].first, transitions[i].second};
+            for (int e = 0; e < 2; ++e) {
+                if (clusterOf(keyToCell(ends[e])) != c) continue;
+                if (std::find(cluster.nodes.begin(), cluster.nodes.end(), ends[e]) == cluster.nodes.end()) {
+                    cluster.nodes.push_back(ends[e]);
+                }
+            }
+        }
+    }
+
+    // Collects the entrance nodes of cluster c and their intra distances.
+    // Borders touching c are owned by c and its left, upper and upper-left
+    // neighbours.
+    void buildCluster(int c) {
+        Cluster& cluster = clusters[c];
+        for (size_t i = 0; i < cluster.nodes.size(); ++i) node_index.erase(cluster.nodes[i]);
+        cluster.nodes.clear();
+
+        int cx = c % clusters_x, cy = c / clusters_x;
+        for (int oy = std::max(cy - 1, 0); oy <= cy; ++oy) {
+            for (int ox = std::max(cx - 1, 0); ox <= cx; ++ox) {
+                for (int kind = 0; kind < 3; ++kind) {
+                    addTransitionNodes(borders[kind][oy * clusters_x + ox], c);
+                }
+            }
+        }
+
+        size_t n = cluster.nodes.size();
+        cluster.distances.assign(n * n, std::numeric_limits<double>::infinity());
+        for (size_t i = 0; i < n; ++i) {
+            node_index[cluster.nodes[i]] = static_cast<int>(i);
+            clusterDijkstra(c, keyToCell(cluster.nodes[i]));
+            for (size_t j = 0; j < n; ++j) {
+                cluster.distances[i * n + j] = localDistance(c, keyToCell(cluster.nodes[j]));
+            }
+        }
+    }
+
+    // Links both ends of each transition in `crossings`
+    void addCrossings(const std::vector<Transition>& transitions) {
+        for (size_t i = 0; i < transitions.size(); ++i) {
+            Transition reverse = {transitions[i].second, transitions[i].first, transitions[i].cost};
+            crossings[transitions[i].first].push_back(transitions[i]);
+            crossings[transitions[i].second].push_back(reverse);
+        }
+    }
+
+    void removeCrossing(int from, int to) {
+        std::unordered_map<int, std::vector<Transition> >::iterator found = crossings.find(from);
+        if (found == crossings.end()) return;
+        std::vector<Transition>& list = found->second;
+        for (size_t j = 0; j < list.size(); ++j) {
+            if (list[j].second != to) continue;
+            list.erase(list.begin() + j);
+            break;
+        }
+        if (list.empty()) crossings.erase(found);
+    }
+
+    // Undoes addCrossings(); a cell pair crosses exactly one border, so
+    // the entries removed are the ones this border added
+    void removeCrossings(const std::vector<Transition>& transitions) {
+        for (size_t i = 0; i < transitions.size(); ++i) {
+            removeCrossing(transitions[i].first, transitions[i].second);
+            removeCrossing(transitions[i].second, transitions[i].first);
+        }
+    }
+
+    // Distances from cell to the entrance nodes of its cluster
+    void connectEndpoint(const Cell& cell, std::vector<double>& distances) {
+        int c = clusterOf(cell);
+        clusterDijkstra(c, cell);
+        const Cluster& cluster = clusters[c];
+        distances.resize(cluster.nodes.size());
+        for (size_t i = 0; i < cluster.nodes.size(); ++i) {
+            distances[i] = localDistance(c, keyToCell(cluster.nodes[i]));
+        }
+    }
+
+    // Abstract neighbours of key as (neighbour key, edge cost)
+    void abstractNeighbors(int key, int start_key, int goal_key, std::vector<std::pair<int, double> >& out) {
+        out.clear();
+        double inf = std::numeric_limits<double>::infinity();
+        Cell cell = keyToCell(key);
+        Cell goal = keyToCell(goal_key);
+        int c = clusterOf(cell);
+        const Cluster& cluster = clusters[c];
+        size_t n = cluster.nodes.size();
+
+        if (key == start_key) {
+            for (size_t j = 0; j < n; ++j) {
+                if (start_distances[j] < inf) out.push_back(std::make_pair(cluster.nodes[j], start_distances[j]));
+            }
+            if (start_goal_distance < inf) out.push_back(std::make_pair(goal_key, start_goal_distance));
+        }
+
+        std::unordered_map<int, std::vector<Transition> >::const_iterator partners = crossings.find(key);
+        if (partners != crossings.end()) {
+            for (size_t j = 0; j < partners->second.size(); ++j) {
+                out.push_back(std::make_pair(partners->second[j].second, partners->second[j].cost));
+            }
+        }
+
+        std::unordered_map<int, int>::const_iterator found = node_index.find(key);
+        if (key == start_key || found == node_index.end()) return;
+        size_t i = found->second;
+        for (size_t j = 0; j < n; ++j) {
+            double d = cluster.distances[i * n + j];
+            if (j != i && d < inf) out.push_back(std::make_pair(cluster.nodes[j], d));
+        }
+        if (clusterOf(goal) == c && goal_distances[i] < inf) {
+            out.push_back(std::make_pair(goal_key, goal_distances[i]));
+        }
+    }
+
+    int abstractSlot(int key) {
+        std::unordered_map<int, int>::iterator found = abstract_slots.find(key);
+        if (found != abstract_slots.end()) return found->second;
+        int slot = static_cast<int>(abstract_keys.size());
+        abstract_slots[key] = slot;
+        abstract_keys.push_back(key);
+        abstract_g.push_back(std::numeric_limits<double>::infinity());
+        abstract_parent.push_back(-1);
+        return slot;
+    }
+
+public:
+    HierarchicalAStar(const Grid& g, Heuristic h, int cluster_edge = 32)
+        : grid(g), heuristic(h), cluster_size(cluster_edge), refiner(g, h),
+          refined_segments(0), path_cost(0), abstract_cost(0), nodes_expanded(0) {
+        clusters_x = (grid.width + cluster_size - 1) / cluster_size;
+        clusters_y = (grid.height + cluster_size - 1) / cluster_size;
+        clusters.resize(clusters_x * clusters_y);
+        for (int kind = 0; kind < 3; ++kind) borders[kind].resize(clusters.size());
+        for (int cy = 0; cy < clusters_y; ++cy) {
+            for (int cx = 0; cx < clusters_x; ++cx) {
+                Cluster& cluster = clusters[cy * clusters_x + cx];
+                cluster.x0 = cx * cluster_size;
+                cluster.y0 = cy * cluster_size;
+                cluster.x1 = std::min(cluster.x0 + cluster_size, grid.width);
+                cluster.y1 = std::min(cluster.y0 + cluster_size, grid.height);
+            }
+        }
+        for (size_t c = 0; c < clusters.size(); ++c) buildBorders(static_cast<int>(c));
+        for (size_t c = 0; c < clusters.size(); ++c) buildCluster(static_cast<int>(c));
+        for (int kind = 0; kind < 3; ++kind) {
+            for (size_t c = 0; c < clusters.size(); ++c) addCrossings(borders[kind][c]);
+        }
+    }
+
+    // Call after editing the grid. Only the borders touching a cluster
+    // with a changed cell are rescanned, their transitions swapped in
+    // `crossings`, and only the clusters sharing those borders get new
+    // entrance nodes and distances, so the work does not grow with the map.
+    void updateObstacles(const std::vector<Cell>& changed) {
+        std::vector<int> rescan;
+        std::vector<int> rebuild;
+        for (size_t i = 0; i < changed.size(); ++i) {
+            int c = clusterOf(changed[i]);
+            int cx = c % clusters_x, cy = c / clusters_x;
+            for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, clusters_y - 1); ++ny) {
+                for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, clusters_x - 1); ++nx) {
+                    if (ny <= cy && nx <= cx) rescan.push_back(ny * clusters_x + nx);
+                    rebuild.push_back(ny * clusters_x + nx);
+                }
+            }
+        }
+        std::sort(rescan.begin(), rescan.end());
+        rescan.erase(std::unique(rescan.begin(), rescan.end()), rescan.end());
+        std::sort(rebuild.begin(), rebuild.end());
+        rebuild.erase(std::unique(rebuild.begin(), rebuild.end()), rebuild.end());
+
+        for (size_t i = 0; i < rescan.size(); ++i) {
+            for (int kind = 0; kind < 3; ++kind) removeCrossings(borders[kind][rescan[i]]);
+            buildBorders(rescan[i]);
+            for (int kind = 0; kind < 3; ++kind) addCrossings(borders[kind][rescan[i]]);
+        }
+        for (size_t i = 0; i < rebuild.size(); ++i) buildCluster(rebuild[i]);
+    }
+
+    bool findPath() {
+        return findPath(grid.start, grid.goal);
+    }
+
+    bool findPath(const Cell& start, const Cell& goal) {
+        if (!findAbstractPath(start, goal)) return false;
+        refine(abstract_path.size());
+        return true;
+    }
+
+    // Searches the abstract graph only; refine() then turns the abstract
+    // path into grid cells a few segments at a time.
+    bool findAbstractPath(const Cell& start, const Cell& goal) {
+        double inf = std::numeric_limits<double>::infinity();
+        abstract_path.clear();
+        refined_segments = 0;
+        path.clear();
+        path_cost = 0;
+        abstract_cost = 0;
+        nodes_expanded = 0;
+
+        int start_key = cellToKey(start), goal_key = cellToKey(goal);
+        connectEndpoint(goal, goal_distances);
+        start_goal_distance = clusterOf(start) == clusterOf(goal) ? localDistance(clusterOf(goal), start) : inf;
+        connectEndpoint(start, start_distances);
+
+        abstract_slots.clear();
+        abstract_keys.clear();
+        abstract_g.clear();
+        abstract_parent.clear();
+        abstract_open.reset(static_cast<int>(node_index.size()) + 2);
+
+        int start_slot = abstractSlot(start_key);
+        abstract_g[start_slot] = 0;
+        abstract_open.push(start_slot, heuristic(start, goal));
+
+        std::vector<std::pair<int, double> > neighbors;
+        while (!abstract_open.empty()) {
+            int slot = abstract_open.pop();
+            int key = abstract_keys[slot];
+            nodes_expanded++;
+            if (key == goal_key) {
+                abstract_cost = abstract_g[slot];
+                for (int s = slot; s != -1; s = abstract_parent[s]) abstract_path.push_back(abstract_keys[s]);
+                std::reverse(abstract_path.begin(), abstract_path.end());
+                path.push_back(start);
+                return true;
+            }
+            double g = abstract_g[slot];
+            abstractNeighbors(key, start_key, goal_key, neighbors);
+            for (size_t i = 0; i < neighbors.size(); ++i) {
+                int next_slot = abstractSlot(neighbors[i].first);
+                double new_g = g + neighbors[i].second;
+                if (new_g >= abstract_g[next_slot]) continue;
+                abstract_g[next_slot] = new_g;
+                abstract_parent[next_slot] = slot;
+                double f = new_g + heuristic(keyToCell(neighbors[i].first), goal);
+                if (abstract_open.contains(next_slot)) abstract_open.decrease(next_slot, f);
+                else abstract_open.push(next_slot, f);
+            }
+        }
+        return false;
+    }
+
+    // Appends up to `segments` more refined abstract edges to the path
+    void refine(size_t segments) {
+        while (segments-- > 0 && refined_segments + 1 < abstract_path.size()) {
+            Cell from = keyToCell(abstract_path[refined_segments]);
+            Cell to = keyToCell(abstract_path[refined_segments + 1]);
+            refined_segments++;
+            if (from == to) continue;
+            if (std::abs(from.x - to.x) <= 1 && std::abs(from.y - to.y) <= 1) {
+                path.push_back(to);
+                path_cost += (from.x != to.x && from.y != to.y) ? 1.414 : 1.0;
+                continue;
+            }
+            refiner.findPath(from, to);
+            const std::vector<Cell>& segment = refiner.getPath();
+            path.insert(path.end(), segment.begin() + 1, segment.end());
+            path_cost += refiner.getPathCost();
+            nodes_expanded += refiner.getNodesExpanded();
+        }
+    }
+
+    bool isFullyRefined() const {
+        return refined_segments + 1 >= abstract_path.size();
+    }
+
+    int getPathLength() const {
+        return path.size();
+    }
+
+    // Cost of the refined part of the path
+    double getPathCost() const {
+        return path_cost;
+    }
+
+    double getAbstractCost() const {
+        return abstract_cost;
+    }
+
+    int getNodesExpanded() const {
+        return nodes_expanded;
+    }
+
+    int getAbstractNodeCount() const {
+        return static_cast<int>(node_index.size());
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+};
+
+#endif
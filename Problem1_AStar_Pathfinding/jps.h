@@ -0,0 +1,286 @@
+#ifndef JPS_H
+#define JPS_H
+
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "search_state.h"
+#include "open_list.h"
+
+// Jump Point Search (JPS+) for the movement model AStar uses: 8-connected,
+// straight moves cost 1, diagonal moves cost 1.414 and may pass between
+// blocked corners. Instead of scanning during the search, the constructor
+// precomputes for every cell and direction how far the next jump point is,
+// and the search only adds nodes at jump points. Paths have the same
+// optimal cost as AStar with the same admissible heuristic.
+//
+// Jump distances are stored as int16_t, so width and height must be
+// below 32768. Like AStar, the solver references the grid.
+class JumpPointSearch {
+private:
+    // E, W, S, N, then SE, SW, NE, NW
+    static const int DX[8];
+    static const int DY[8];
+
+    const Grid& grid;
+    Heuristic heuristic;
+    // jump_distances[key * 8 + dir]: d > 0 means a jump point d steps away,
+    // d <= 0 means -d free steps before a wall with no jump point.
+    std::vector<int16_t> jump_distances;
+    SearchState state;
+    QuaternaryHeapOpenList open_list;
+    std::vector<Cell> path;
+    int nodes_expanded;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    static int directionIndex(int dx, int dy) {
+        for (int dir = 0; dir < 8; ++dir) {
+            if (DX[dir] == dx && DY[dir] == dy) return dir;
+        }
+        return -1;
+    }
+
+    bool free(int x, int y) const {
+        return !grid.isObstacle(x, y);
+    }
+
+    // Does arriving at (x, y) while moving in dir expose a forced neighbor?
+    bool isForced(int x, int y, int dx, int dy) const {
+        if (dx != 0 && dy != 0) {
+            return (free(x - dx, y + dy) && !free(x - dx, y)) ||
+                   (free(x + dx, y - dy) && !free(x, y - dy));
+        }
+        if (dx != 0) {
+            return (free(x + dx, y + 1) && !free(x, y + 1)) ||
+                   (free(x + dx, y - 1) && !free(x, y - 1));
+        }
+        return (free(x + 1, y + dy) && !free(x + 1, y)) ||
+               (free(x - 1, y + dy) && !free(x - 1, y));
+    }
+
+    int16_t& distance(int x, int y, int dir) {
+        return jump_distances[static_cast<size_t>(y * grid.width + x) * 8 + dir];
+    }
+
+    // Distance for (x, y) given the entry of the next cell along dir
+    static int16_t extend(int16_t next) {
+        return next > 0 ? next + 1 : next - 1;
+    }
+
+    void sweepStraight(int dir) {
+        int dx = DX[dir], dy = DY[dir];
+        // Visit cells so that the next cell along dir is already done
+        int x_begin = dx > 0 ? grid.width - 1 : 0, x_end = dx > 0 ? -1 : grid.width, x_step = dx > 0 ? -1 : 1;
+        int y_begin = dy > 0 ? grid.height - 1 : 0, y_end = dy > 0 ? -1 : grid.height, y_step = dy > 0 ? -1 : 1;
+        for (int y = y_begin; y != y_end; y += y_step) {
+            for (int x = x_begin; x != x_end; x += x_step) {
+                int nx = x + dx, ny = y + dy;
+                int16_t& d = distance(x, y, dir);
+                if (!free(nx, ny)) d = 0;
+                else if (isForced(nx, ny, dx, dy)) d = 1;
+                else d = extend(distance(nx, ny, dir));
+            }
+        }
+    }
+
+    void sweepDiagonal(int dir) {
+        int dx = DX[dir], dy = DY[dir];
+        int y_begin = dy > 0 ? grid.height - 1 : 0, y_end = dy > 0 ? -1 : grid.height, y_step = dy > 0 ? -1 : 1;
+        int horizontal = directionIndex(dx, 0), vertical = directionIndex(0, dy);
+        for (int y = y_begin; y != y_end; y += y_step) {
+            for (int x = 0; x < grid.width; ++x) {
+                int nx = x + dx, ny = y + dy;
+                int16_t& d = distance(x, y, dir);
+                if (!free(nx, ny)) {
+                    d = 0;
+                } else if (isForced(nx, ny, dx, dy) ||
+                           distance(nx, ny, horizontal) > 0 || distance(nx, ny, vertical) > 0) {
+                    d = 1;
+                } else {
+                    d = extend(distance(nx, ny, dir));
+                }
+            }
+        }
+    }
+
+    void precompute() {
+        jump_distances.assign(static_cast<size_t>(grid.width) * grid.height * 8, 0);
+        for (int dir = 0; dir < 4; ++dir) sweepStraight(dir);
+        for (int dir = 4; dir < 8; ++dir) sweepDiagonal(dir);
+    }
+
+    // Follows dir from cell using the table, stopping early at the goal or
+    // at the diagonal cell in line with it. Returns the number of steps, or
+    // 0 when no successor lies in that direction.
+    int jump(const Cell& cell, int dir, const Cell& goal) const {
+        int d = jump_distances[static_cast<size_t>(cellToKey(cell)) * 8 + dir];
+        int reach = std::abs(d);
+        int dx = DX[dir], dy = DY[dir];
+        int to_goal_x = (goal.x - cell.x) * dx;
+        int to_goal_y = (goal.y - cell.y) * dy;
+
+        if (dx != 0 && dy != 0) {
+            if (to_goal_x > 0 && to_goal_y > 0) {
+                int steps = std::min(to_goal_x, to_goal_y);
+                if (steps <= reach) return steps;
+            }
+        } else if (dx != 0 ? (goal.y == cell.y && to_goal_x > 0) : (goal.x == cell.x && to_goal_y > 0)) {
+            int steps = dx != 0 ? to_goal_x : to_goal_y;
+            if (steps <= reach) return steps;
+        }
+        return d > 0 ? d : 0;
+    }
+
+    // Directions worth following from cell when it was entered moving
+    // (dx, dy); all eight for the start node.
+    int successorDirections(const Cell& cell, int dx, int dy, int* dirs) const {
+        int count = 0;
+        if (dx == 0 && dy == 0) {
+            for (int dir = 0; dir < 8; ++dir) dirs[count++] = dir;
+            return count;
+        }
+        int x = cell.x, y = cell.y;
+        if (dx != 0 && dy != 0) {
+            dirs[count++] = directionIndex(dx, 0);
+            dirs[count++] = directionIndex(0, dy);
+            dirs[count++] = directionIndex(dx, dy);
+            if (!free(x - dx, y)) dirs[count++] = directionIndex(-dx, dy);
+            if (!free(x, y - dy)) dirs[count++] = directionIndex(dx, -dy);
+        } else if (dx != 0) {
+            dirs[count++] = directionIndex(dx, 0);
+            if (!free(x, y + 1)) dirs[count++] = directionIndex(dx, 1);
+            if (!free(x, y - 1)) dirs[count++] = directionIndex(dx, -1);
+        } else {
+            dirs[count++] = directionIndex(0, dy);
+            if (!free(x + 1, y)) dirs[count++] = directionIndex(1, dy);
+            if (!free(x - 1, y)) dirs[count++] = directionIndex(-1, dy);
+        }
+        return count;
+    }
+
+    static int sign(int v) {
+        return (v > 0) - (v < 0);
+    }
+
+    // Expands the chain of jump points into every cell along the way
+    void reconstructPath(int key) {
+        path.clear();
+        while (key != -1) {
+            Cell cell = keyToCell(key);
+            int parent = state.parent(key);
+            if (parent == -1) {
+                path.push_back(cell);
+                break;
+            }
+            Cell from = keyToCell(parent);
+            int dx = sign(from.x - cell.x), dy = sign(from.y - cell.y);
+            for (Cell c = cell; !(c == from); c.x += dx, c.y += dy) {
+                path.push_back(c);
+            }
+            key = parent;
+        }
+        std::reverse(path.begin(), path.end());
+    }
+
+public:
+    JumpPointSearch(const Grid& g, Heuristic h) : grid(g), heuristic(h), nodes_expanded(0) {
+        precompute();
+    }
+
+    bool findPath() {
+        return findPath(grid.start, grid.goal);
+    }
+
+    bool findPath(const Cell& start, const Cell& goal) {
+        state.reset(grid.width * grid.height);
+        open_list.reset(grid.width * grid.height);
+        path.clear();
+        nodes_expanded = 0;
+
+        int start_key = cellToKey(start);
+        state.open(start_key, 0, -1);
+        open_list.push(start_key, heuristic(start, goal));
+
+        int dirs[8];
+        while (!open_list.empty()) {
+            int current_key = open_list.pop();
+            state.close(current_key);
+
+            nodes_expanded++;
+
+            Cell current = keyToCell(current_key);
+            if (current == goal) {
+                reconstructPath(current_key);
+                return true;
+            }
+
+            int dx = 0, dy = 0;
+            int parent_key = state.parent(current_key);
+            if (parent_key != -1) {
+                Cell parent = keyToCell(parent_key);
+                dx = sign(current.x - parent.x);
+                dy = sign(current.y - parent.y);
+            }
+
+            double current_g = state.g(current_key);
+            int count = successorDirections(current, dx, dy, dirs);
+            for (int i = 0; i < count; ++i) {
+                int dir = dirs[i];
+                int steps = jump(current, dir, goal);
+                if (steps == 0) continue;
+
+                Cell successor = {current.x + DX[dir] * steps, current.y + DY[dir] * steps};
+                double new_g_cost = current_g + steps * (dir >= 4 ? 1.414 : 1.0);
+                int successor_key = cellToKey(successor);
+                SearchState::Status status = state.status(successor_key);
+
+                if (status == SearchState::UNSEEN) {
+                    state.open(successor_key, new_g_cost, current_key);
+                    open_list.push(successor_key, new_g_cost + heuristic(successor, goal));
+                } else if (new_g_cost < state.g(successor_key)) {
+                    double f_cost = new_g_cost + heuristic(successor, goal);
+                    state.open(successor_key, new_g_cost, current_key);
+                    if (status == SearchState::CLOSED) {
+                        open_list.push(successor_key, f_cost);
+                    } else {
+                        open_list.decrease(successor_key, f_cost);
+                    }
+                }
+            }
+        }
+
+        return false; // No path found
+    }
+
+    int getPathLength() const {
+        return path.size();
+    }
+
+    double getPathCost() const {
+        return path.empty() ? 0 : state.g(cellToKey(path.back()));
+    }
+
+    int getNodesExpanded() const {
+        return nodes_expanded;
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+};
+
+const int JumpPointSearch::DX[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+const int JumpPointSearch::DY[8] = {0, 0, 1, -1, 1, 1, -1, -1};
+
+#endif
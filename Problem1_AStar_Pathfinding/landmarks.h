@@ -0,0 +1,243 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "open_list.h"
+#include "mapped_file.h"
+
+// Landmark (ALT) heuristic. A few landmark cells are chosen and the exact
+// path cost from each landmark to every cell is precomputed with Dijkstra.
+// By the triangle inequality |d(L, a) - d(L, b)| <= d(a, b) for every
+// landmark L, so the largest such difference is an admissible estimate
+// that, unlike the plain distance heuristics, accounts for obstacles.
+//
+// Distances are stored as 16-bit fixed point, all landmarks of one cell
+// side by side so a lookup touches one cache line per cell. Rounding is
+// absorbed by subtracting one unit from each difference, which keeps the
+// estimate admissible; it may then be off from consistent by a rounding
+// step, which the solvers tolerate because they reopen closed cells.
+//
+// The table belongs to the grid it was built for. It must be rebuilt after
+// obstacles change.
+class LandmarkTable {
+private:
+    static const uint16_t UNREACHABLE = 0xFFFF;
+    static const uint16_t MAX_UNITS = 0xFFFE;
+
+    // File layout: this header, `count` landmark cells, then the table
+    struct FileHeader {
+        char magic[8];
+        uint32_t width;
+        uint32_t height;
+        uint32_t count;
+        uint32_t reserved;
+        double scale;
+    };
+
+    int width;
+    int height;
+    int count;
+    double scale; // table units per unit of path cost
+    std::vector<Cell> landmarks;
+    std::vector<uint16_t> owned;
+    MappedFile mapped;
+    const uint16_t* table;
+
+    static const char* magic() {
+        return "ALTLMK1";
+    }
+
+    // Exact costs from source to every cell, infinity when unreachable
+    static void dijkstra(const Grid& grid, const Cell& source, std::vector<double>& dist) {
+        static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
+        int num_cells = grid.width * grid.height;
+        dist.assign(num_cells, std::numeric_limits<double>::infinity());
+        BinaryHeapOpenList open_list;
+        open_list.reset(num_cells);
+        int source_key = source.y * grid.width + source.x;
+        dist[source_key] = 0;
+        open_list.push(source_key, 0);
+        while (!open_list.empty()) {
+            int key = open_list.pop();
+            int x = key % grid.width;
+            int y = key / grid.width;
+            for (int i = 0; i < 8; ++i) {
+                int nx = x + dx[i];
+                int ny = y + dy[i];
+                if (grid.isObstacle(nx, ny)) continue;
+                int next = ny * grid.width + nx;
+                double cost = dist[key] + (i < 4 ? 1.0 : 1.414);
+                if (cost < dist[next]) {
+                    if (dist[next] == std::numeric_limits<double>::infinity()) {
+                        open_list.push(next, cost);
+                    } else {
+                        open_list.decrease(next, cost);
+                    }
+                    dist[next] = cost;
+                }
+            }
+        }
+    }
+
+    static double estimate(const void* context, const Cell& a, const Cell& b) {
+        const LandmarkTable& self = *static_cast<const LandmarkTable*>(context);
+        const uint16_t* qa = self.table + static_cast<size_t>(a.y * self.width + a.x) * self.count;
+        const uint16_t* qb = self.table + static_cast<size_t>(b.y * self.width + b.x) * self.count;
+        int best = 0;
+        for (int i = 0; i < self.count; ++i) {
+            if (qa[i] == UNREACHABLE || qb[i] == UNREACHABLE) continue;
+            best = std::max(best, std::abs(static_cast<int>(qa[i]) - static_cast<int>(qb[i])));
+        }
+        return std::max(octileDistance(a, b), (best - 1) / self.scale);
+    }
+
+public:
+    LandmarkTable() : width(0), height(0), count(0), scale(1), table(nullptr) {}
+
+    // Picks num_landmarks cells by farthest-point selection: each new
+    // landmark is the reachable cell farthest from all earlier ones. The
+    // first is the cell farthest from the grid's start cell, so the
+    // landmarks cover the start's connected region.
+    void build(const Grid& grid, int num_landmarks) {
+        mapped.close();
+        width = grid.width;
+        height = grid.height;
+        count = 0;
+        landmarks.clear();
+        int num_cells = width * height;
+
+        std::vector<double> nearest(num_cells, std::numeric_limits<double>::infinity());
+        std::vector<double> dist;
+        dijkstra(grid, grid.start, dist);
+        Cell next = grid.start;
+        double farthest = -1;
+        for (int key = 0; key < num_cells; ++key) {
+            if (dist[key] != std::numeric_limits<double>::infinity() && dist[key] > farthest) {
+                farthest = dist[key];
+                next.x = key % width;
+                next.y = key / width;
+            }
+        }
+
+        // Landmarks lie in the start's region, so by the triangle
+        // inequality no stored distance exceeds twice the start's farthest
+        // one. Fixing the scale up front lets each landmark's distances be
+        // quantized as soon as its Dijkstra ends, with one buffer reused.
+        scale = MAX_UNITS / std::max(2 * farthest, 1.0);
+        owned.assign(static_cast<size_t>(num_cells) * num_landmarks, UNREACHABLE);
+        for (int l = 0; l < num_landmarks && farthest > 0; ++l) {
+            landmarks.push_back(next);
+            dijkstra(grid, next, dist);
+            farthest = 0;
+            for (int key = 0; key < num_cells; ++key) {
+                double d = dist[key];
+                if (d == std::numeric_limits<double>::infinity()) continue;
+                owned[static_cast<size_t>(key) * num_landmarks + l] = static_cast<uint16_t>(d * scale + 0.5);
+                nearest[key] = std::min(nearest[key], d);
+                if (nearest[key] > farthest) {
+                    farthest = nearest[key];
+                    next.x = key % width;
+                    next.y = key / width;
+                }
+            }
+        }
+        count = landmarks.size();
+
+        // Fewer landmarks than asked for: close up the rows in place
+        if (count < num_landmarks) {
+            for (size_t key = 0; key < static_cast<size_t>(num_cells); ++key) {
+                for (int l = 0; l < count; ++l) owned[key * count + l] = owned[key * num_landmarks + l];
+            }
+            owned.resize(static_cast<size_t>(num_cells) * count);
+            owned.shrink_to_fit();
+        }
+        table = owned.data();
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream out(path.c_str(), std::ios::binary);
+        if (!out) return false;
+        FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, magic(), sizeof(header.magic));
+        header.width = width;
+        header.height = height;
+        header.count = count;
+        header.scale = scale;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int l = 0; l < count; ++l) {
+            int32_t xy[2] = {landmarks[l].x, landmarks[l].y};
+            out.write(reinterpret_cast<const char*>(xy), sizeof(xy));
+        }
+        out.write(reinterpret_cast<const char*>(table), static_cast<size_t>(width) * height * count * sizeof(uint16_t));
+        return static_cast<bool>(out);
+    }
+
+    // Maps a table written by save(). The distances are read in place, so
+    // nothing is recomputed or copied. Fails if the file is malformed or
+    // was built for a grid of another size.
+    bool load(const std::string& path, const Grid& grid) {
+        MappedFile file;
+        if (!file.open(path) || file.size() < sizeof(FileHeader)) return false;
+        FileHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, magic(), sizeof(header.magic)) != 0) return false;
+        if (header.width != static_cast<uint32_t>(grid.width) || header.height != static_cast<uint32_t>(grid.height)) {
+            return false;
+        }
+        size_t cells_offset = sizeof(FileHeader);
+        size_t table_offset = cells_offset + header.count * 2 * sizeof(int32_t);
+        size_t table_bytes = static_cast<size_t>(header.width) * header.height * header.count * sizeof(uint16_t);
+        if (file.size() != table_offset + table_bytes || !(header.scale > 0)) return false;
+
+        width = header.width;
+        height = header.height;
+        count = header.count;
+        scale = header.scale;
+        landmarks.resize(count);
+        for (int l = 0; l < count; ++l) {
+            int32_t xy[2];
+            std::memcpy(xy, file.data() + cells_offset + l * sizeof(xy), sizeof(xy));
+            landmarks[l].x = xy[0];
+            landmarks[l].y = xy[1];
+        }
+        owned.clear();
+        owned.shrink_to_fit();
+        mapped.swap(file);
+        table = reinterpret_cast<const uint16_t*>(mapped.data() + table_offset);
+        return true;
+    }
+
+    // Heuristic reading this table; valid while the table is alive and
+    // not rebuilt or reloaded
+    Heuristic heuristic() const {
+        return Heuristic(&LandmarkTable::estimate, this);
+    }
+
+    int landmarkCount() const {
+        return count;
+    }
+
+    const std::vector<Cell>& getLandmarks() const {
+        return landmarks;
+    }
+
+    size_t memoryBytes() const {
+        return static_cast<size_t>(width) * height * count * sizeof(uint16_t);
+    }
+};
+
+const uint16_t LandmarkTable::UNREACHABLE;
+const uint16_t LandmarkTable::MAX_UNITS;
+
+#endif
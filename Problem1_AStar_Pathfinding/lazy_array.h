@@ -0,0 +1,56 @@
+#ifndef LAZY_ARRAY_H
+#define LAZY_ARRAY_H
+
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <new>
+
+// Fixed-size array of a trivially copyable type backed by calloc. Large
+// blocks come straight from the OS as zero pages that are only mapped in
+// when first written, so per-cell scratch for a huge map costs memory in
+// proportion to the cells a search actually visits.
+template <class T>
+class LazyArray {
+private:
+    T* items;
+    size_t count;
+
+    LazyArray(const LazyArray&);
+    LazyArray& operator=(const LazyArray&);
+
+public:
+    LazyArray() : items(nullptr), count(0) {}
+
+    ~LazyArray() {
+        std::free(items);
+    }
+
+    // Replaces the contents with n zero bytes' worth of elements. Throws
+    // std::bad_alloc, as std::vector would, when the memory is not there;
+    // the array is then left empty.
+    void allocate(size_t n) {
+        std::free(items);
+        items = n ? static_cast<T*>(std::calloc(n, sizeof(T))) : nullptr;
+        count = items ? n : 0;
+        if (n && !items) throw std::bad_alloc();
+    }
+
+    void clear() {
+        if (count) std::memset(items, 0, count * sizeof(T));
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    T& operator[](size_t i) {
+        return items[i];
+    }
+
+    const T& operator[](size_t i) const {
+        return items[i];
+    }
+};
+
+#endif
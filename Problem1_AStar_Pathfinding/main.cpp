@@ -3,9 +3,37 @@
 #include <fstream>
 #include <chrono>
 #include <random>
+#include <cmath>
+#include <memory>
+#include <queue>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <mutex>
 #include "grid_generator.h"
 #include "astar.h"
 #include "heuristics.h"
+#include "jps.h"
+#include "batch_pathfinder.h"
+#include "bidirectional_astar.h"
+#include "hpa_star.h"
+#include "dstar_lite.h"
+#include "landmarks.h"
+#include "map_loader.h"
+#include "tiled_map.h"
+#include "benchmark.h"
+#include "bitboard.h"
+#include "flow_field.h"
+#include "ara_star.h"
+#include "path_cache.h"
+#include "map_generator.h"
+#include "cooperative_astar.h"
+#include "map_snapshot.h"
+#include "sma_star.h"
+#include "hda_star.h"
+#include "path_database.h"
+#include "clearance_map.h"
+#include "path_server.h"
 
 using namespace std;
 
@@ -17,16 +45,15 @@ struct PerformanceMetrics {
 };
 
 PerformanceMetrics runAStarForHeuristic(Grid& grid, HeuristicFunction heuristic, const string& heuristic_name) {
-    auto start = chrono::high_resolution_clock::now();
+    auto start = chrono::steady_clock::now();
     
     AStar astar(grid, heuristic);
     bool success = astar.findPath();
     
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
+    auto end = chrono::steady_clock::now();
     
     PerformanceMetrics metrics;
-    metrics.time_taken = duration.count();
+    metrics.time_taken = chrono::duration_cast<chrono::nanoseconds>(end - start).count() * 1e-9;
     metrics.path_length = astar.getPathLength();
     metrics.nodes_expanded = astar.getNodesExpanded();
     metrics.path_found = success;
@@ -34,17 +61,1710 @@ PerformanceMetrics runAStarForHeuristic(Grid& grid, HeuristicFunction heuristic,
     return metrics;
 }
 
-int main() {
+// Runtime selection of a compile-time specialized solver. The virtual
+// call happens once per query; inside findPath the heuristic and the
+// neighborhood are inlined.
+class AnyPathfinder {
+public:
+    virtual ~AnyPathfinder() {}
+    virtual bool findPath(const Cell& start, const Cell& goal) = 0;
+    virtual double getPathCost() const = 0;
+    virtual int getNodesExpanded() const = 0;
+};
+
+template <class Solver>
+class PathfinderModel : public AnyPathfinder {
+private:
+    Solver solver;
+
+public:
+    explicit PathfinderModel(const Grid& grid) : solver(grid) {}
+
+    bool findPath(const Cell& start, const Cell& goal) {
+        return solver.findPath(start, goal);
+    }
+
+    double getPathCost() const {
+        return solver.getPathCost();
+    }
+
+    int getNodesExpanded() const {
+        return solver.getNodesExpanded();
+    }
+};
+
+template <class Neighborhood>
+unique_ptr<AnyPathfinder> makePathfinderFor(const Grid& grid, const string& heuristic) {
+    if (heuristic == "manhattan") {
+        return unique_ptr<AnyPathfinder>(
+            new PathfinderModel<BasicAStar<QuaternaryHeapOpenList, Manhattan, Neighborhood> >(grid));
+    }
+    if (heuristic == "euclidean") {
+        return unique_ptr<AnyPathfinder>(
+            new PathfinderModel<BasicAStar<QuaternaryHeapOpenList, Euclidean, Neighborhood> >(grid));
+    }
+    if (heuristic == "chebyshev") {
+        return unique_ptr<AnyPathfinder>(
+            new PathfinderModel<BasicAStar<QuaternaryHeapOpenList, Chebyshev, Neighborhood> >(grid));
+    }
+    if (heuristic == "octile") {
+        return unique_ptr<AnyPathfinder>(
+            new PathfinderModel<BasicAStar<QuaternaryHeapOpenList, Octile, Neighborhood> >(grid));
+    }
+    return unique_ptr<AnyPathfinder>();
+}
+
+// heuristic: manhattan, euclidean, chebyshev or octile.
+// neighborhood: "4", "8", or "8-no-corners". Returns null for unknown names.
+unique_ptr<AnyPathfinder> makePathfinder(const Grid& grid, const string& heuristic, const string& neighborhood) {
+    if (neighborhood == "4") return makePathfinderFor<FourConnected>(grid, heuristic);
+    if (neighborhood == "8") return makePathfinderFor<EightConnected>(grid, heuristic);
+    if (neighborhood == "8-no-corners") return makePathfinderFor<EightConnectedNoCornerCutting>(grid, heuristic);
+    return unique_ptr<AnyPathfinder>();
+}
+
+template <class Solver>
+double timeQuery(Solver& solver, const Grid& grid, bool& found, int& expanded) {
+    auto start = chrono::steady_clock::now();
+    found = solver.findPath(grid.start, grid.goal);
+    auto end = chrono::steady_clock::now();
+    expanded = solver.getNodesExpanded();
+    return chrono::duration<double>(end - start).count();
+}
+
+// Compares the open-list implementations on large grids. Each solver is
+// reused across runs, as a long-lived planner would be.
+void runOpenListComparison() {
+    const int RUNS_PER_SIZE = 10;
+    const int GRID_SIZES[] = {256, 512, 1024};
+    const double OBSTACLE_RATIO = 0.3;
+
+    ofstream data_file("openlist_data.csv");
+    data_file << "GridSize,Run,OpenList,TimeTaken,NodesExpanded,PathFound\n";
+
+    for (int size : GRID_SIZES) {
+        double totals[3] = {0, 0, 0};
+        Grid grid = generateRandomGrid(size, size, OBSTACLE_RATIO, size);
+        BasicAStar<BinaryHeapOpenList> binary(grid, euclideanDistance);
+        BasicAStar<QuaternaryHeapOpenList> quaternary(grid, euclideanDistance);
+        BasicAStar<BucketOpenList> bucket(grid, euclideanDistance);
+        for (int run = 0; run < RUNS_PER_SIZE; ++run) {
+            // The solvers point at `grid`, so they search each run's map
+            if (run > 0) grid = generateRandomGrid(size, size, OBSTACLE_RATIO, size + run);
+
+            bool found[3];
+            int expanded[3];
+            double times[3];
+            times[0] = timeQuery(binary, grid, found[0], expanded[0]);
+            times[1] = timeQuery(quaternary, grid, found[1], expanded[1]);
+            times[2] = timeQuery(bucket, grid, found[2], expanded[2]);
+
+            const char* names[] = {"BinaryHeap", "QuaternaryHeap", "Bucket"};
+            for (int i = 0; i < 3; ++i) {
+                totals[i] += times[i];
+                data_file << size << "," << run + 1 << "," << names[i] << ","
+                          << times[i] << "," << expanded[i] << ","
+                          << (found[i] ? "Yes" : "No") << "\n";
+            }
+        }
+        cout << size << "x" << size << " avg time (s): binary " << totals[0] / RUNS_PER_SIZE
+             << ", 4-ary " << totals[1] / RUNS_PER_SIZE
+             << ", bucket " << totals[2] / RUNS_PER_SIZE << endl;
+    }
+
+    cout << "Open list data saved to openlist_data.csv" << endl;
+}
+
+// Runs A* and JPS+ on the same queries, checks that they agree on the
+// optimal cost and reports the speedup.
+void runJumpPointComparison() {
+    const int RUNS_PER_SIZE = 10;
+    const int GRID_SIZES[] = {256, 512, 1024};
+    const double OBSTACLE_RATIOS[] = {0.1, 0.3};
+
+    ofstream data_file("jps_data.csv");
+    data_file << "GridSize,ObstacleRatio,Run,Solver,TimeTaken,PathCost,NodesExpanded,PathFound\n";
+
+    for (double ratio : OBSTACLE_RATIOS) {
+        for (int size : GRID_SIZES) {
+            double astar_total = 0, jps_total = 0, precompute_total = 0;
+            long long astar_expanded = 0, jps_expanded = 0;
+            int mismatches = 0;
+
+            for (int run = 0; run < RUNS_PER_SIZE; ++run) {
+                Grid grid = generateRandomGrid(size, size, ratio, size + run);
+                AStar astar(grid, octileDistance);
+
+                auto precompute_start = chrono::steady_clock::now();
+                JumpPointSearch jps(grid, octileDistance);
+                precompute_total += chrono::duration<double>(chrono::steady_clock::now() - precompute_start).count();
+
+                bool found[2];
+                int expanded[2];
+                double times[2];
+                times[0] = timeQuery(astar, grid, found[0], expanded[0]);
+                times[1] = timeQuery(jps, grid, found[1], expanded[1]);
+                double costs[2] = {astar.getPathCost(), jps.getPathCost()};
+                if (found[0] != found[1] || fabs(costs[0] - costs[1]) > 1e-6) mismatches++;
+
+                astar_total += times[0];
+                jps_total += times[1];
+                astar_expanded += expanded[0];
+                jps_expanded += expanded[1];
+
+                const char* names[] = {"AStar", "JPS+"};
+                for (int i = 0; i < 2; ++i) {
+                    data_file << size << "," << ratio << "," << run + 1 << "," << names[i] << ","
+                              << times[i] << "," << costs[i] << "," << expanded[i] << ","
+                              << (found[i] ? "Yes" : "No") << "\n";
+                }
+            }
+
+            cout << size << "x" << size << " obstacles " << ratio
+                 << ": A* " << astar_total / RUNS_PER_SIZE << "s (" << astar_expanded / RUNS_PER_SIZE << " nodes)"
+                 << ", JPS+ " << jps_total / RUNS_PER_SIZE << "s (" << jps_expanded / RUNS_PER_SIZE << " nodes)"
+                 << ", speedup " << (jps_total > 0 ? astar_total / jps_total : 0) << "x"
+                 << ", precompute " << precompute_total / RUNS_PER_SIZE << "s"
+                 << ", cost mismatches " << mismatches << endl;
+        }
+    }
+
+    cout << "JPS data saved to jps_data.csv" << endl;
+}
+
+vector<PathQuery> randomQueries(const Grid& grid, int count, mt19937& gen) {
+    uniform_int_distribution<> x_dist(0, grid.width - 1);
+    uniform_int_distribution<> y_dist(0, grid.height - 1);
+    vector<PathQuery> queries;
+    while (static_cast<int>(queries.size()) < count) {
+        PathQuery query = {{x_dist(gen), y_dist(gen)}, {x_dist(gen), y_dist(gen)}};
+        if (grid.isObstacle(query.start.x, query.start.y) || grid.isObstacle(query.goal.x, query.goal.y)) continue;
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+// Throughput of many start/goal queries on one map: a fresh AStar per
+// query against the batch API on one thread and on every hardware thread.
+void runBatchComparison() {
+    const int GRID_SIZE = 512;
+    const int NUM_QUERIES = 2000;
+    const double OBSTACLE_RATIO = 0.2;
+
+    random_device rd;
+    mt19937 gen(rd());
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+
+    auto start = chrono::steady_clock::now();
+    for (const PathQuery& query : queries) {
+        AStar astar(grid, euclideanDistance);
+        astar.findPath(query.start, query.goal);
+    }
+    double fresh_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    BatchPathfinder<> single(grid, euclideanDistance, 1);
+    BatchPathfinder<> parallel(grid, euclideanDistance);
+    PathBatchResult single_result, parallel_result;
+    single.solve(queries, single_result);  // warm up the scratch buffers
+    parallel.solve(queries, parallel_result);
+
+    start = chrono::steady_clock::now();
+    single.solve(queries, single_result);
+    double single_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    parallel.solve(queries, parallel_result);
+    double parallel_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int mismatches = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (single_result.found[i] != parallel_result.found[i] ||
+            fabs(single_result.costs[i] - parallel_result.costs[i]) > 1e-9) mismatches++;
+    }
+
+    cout << NUM_QUERIES << " queries on " << GRID_SIZE << "x" << GRID_SIZE << " (queries/s):" << endl;
+    cout << "  fresh AStar per query: " << NUM_QUERIES / fresh_time << endl;
+    cout << "  batch, 1 thread:       " << NUM_QUERIES / single_time << endl;
+    cout << "  batch, " << parallel.threadCount() << " threads:     " << NUM_QUERIES / parallel_time << endl;
+    cout << "  result cells: " << parallel_result.cells.size() << ", mismatches: " << mismatches << endl;
+}
+
+// Node expansions and wall time of unidirectional and bidirectional A*
+// on the same queries.
+void runBidirectionalComparison() {
+    const int RUNS_PER_SIZE = 10;
+    const int GRID_SIZES[] = {256, 512, 1024};
+    const double OBSTACLE_RATIO = 0.2;
+    const char* names[] = {"AStar", "Bidirectional", "BidirectionalThreaded"};
+
+    ofstream data_file("bidirectional_data.csv");
+    data_file << "GridSize,Run,Solver,TimeTaken,PathCost,NodesExpanded,PathFound\n";
+
+    for (int size : GRID_SIZES) {
+        double times[3] = {0, 0, 0};
+        long long expanded[3] = {0, 0, 0};
+        int mismatches = 0;
+
+        for (int run = 0; run < RUNS_PER_SIZE; ++run) {
+            Grid grid = generateRandomGrid(size, size, OBSTACLE_RATIO, size + run);
+            AStar astar(grid, octileDistance);
+            BidirectionalAStar sequential(grid, octileDistance);
+            BidirectionalAStar threaded(grid, octileDistance, true);
+
+            bool found[3];
+            int nodes[3];
+            double time[3];
+            time[0] = timeQuery(astar, grid, found[0], nodes[0]);
+            time[1] = timeQuery(sequential, grid, found[1], nodes[1]);
+            time[2] = timeQuery(threaded, grid, found[2], nodes[2]);
+            double costs[3] = {astar.getPathCost(), sequential.getPathCost(), threaded.getPathCost()};
+
+            for (int i = 0; i < 3; ++i) {
+                if (found[i] != found[0] || fabs(costs[i] - costs[0]) > 1e-6) mismatches++;
+                times[i] += time[i];
+                expanded[i] += nodes[i];
+                data_file << size << "," << run + 1 << "," << names[i] << "," << time[i] << ","
+                          << costs[i] << "," << nodes[i] << "," << (found[i] ? "Yes" : "No") << "\n";
+            }
+        }
+
+        cout << size << "x" << size << ":";
+        for (int i = 0; i < 3; ++i) {
+            cout << " " << names[i] << " " << times[i] / RUNS_PER_SIZE << "s/"
+                 << expanded[i] / RUNS_PER_SIZE << " nodes" << (i < 2 ? "," : "");
+        }
+        cout << " (cost mismatches " << mismatches << ")" << endl;
+    }
+
+    cout << "Bidirectional data saved to bidirectional_data.csv" << endl;
+}
+
+// HPA* against A* on one large map: build cost, query time, path quality
+// and the cost of repairing the abstract graph after obstacle edits.
+void runHierarchicalComparison() {
+    const int GRID_SIZE = 1024;
+    const int CLUSTER_SIZE = 32;
+    const int NUM_QUERIES = 50;
+    const int NUM_EDITS = 20;
+    const double OBSTACLE_RATIO = 0.2;
+
+    random_device rd;
+    mt19937 gen(rd());
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+
+    auto start = chrono::steady_clock::now();
+    HierarchicalAStar hpa(grid, octileDistance, CLUSTER_SIZE);
+    double build_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    AStar astar(grid, octileDistance);
+
+    double astar_time = 0, hpa_time = 0, cost_ratio = 0;
+    long long astar_expanded = 0, hpa_expanded = 0;
+    int solved = 0;
+    for (const PathQuery& query : queries) {
+        start = chrono::steady_clock::now();
+        bool astar_found = astar.findPath(query.start, query.goal);
+        astar_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        bool hpa_found = hpa.findPath(query.start, query.goal);
+        hpa_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        astar_expanded += astar.getNodesExpanded();
+        hpa_expanded += hpa.getNodesExpanded();
+        if (astar_found && hpa_found && astar.getPathCost() > 0) {
+            cost_ratio += hpa.getPathCost() / astar.getPathCost();
+            solved++;
+        }
+    }
+
+    uniform_int_distribution<> x_dist(0, GRID_SIZE - 1);
+    vector<Cell> edits;
+    for (int i = 0; i < NUM_EDITS; ++i) {
+        Cell cell = {x_dist(gen), x_dist(gen)};
+        grid.setObstacle(cell.x, cell.y, !grid.isObstacle(cell.x, cell.y));
+        edits.push_back(cell);
+    }
+    start = chrono::steady_clock::now();
+    hpa.updateObstacles(edits);
+    double update_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", clusters of " << CLUSTER_SIZE << ", "
+         << hpa.getAbstractNodeCount() << " abstract nodes" << endl;
+    cout << "  build: " << build_time << "s, update after " << NUM_EDITS << " edits: " << update_time << "s" << endl;
+    cout << "  A*:   " << astar_time / NUM_QUERIES << "s/query, " << astar_expanded / NUM_QUERIES << " nodes" << endl;
+    cout << "  HPA*: " << hpa_time / NUM_QUERIES << "s/query, " << hpa_expanded / NUM_QUERIES << " nodes, "
+         << "avg cost ratio " << (solved ? cost_ratio / solved : 0) << endl;
+
+    // One blocked cell on a much larger map should cost no more than on a
+    // small one: only the borders next to it are redone
+    const int LARGE_SIZE = 4096;
+    const int LARGE_CLUSTER_SIZE = 16;
+    Grid large = generateRandomGrid(LARGE_SIZE, LARGE_SIZE, OBSTACLE_RATIO, 7);
+    start = chrono::steady_clock::now();
+    HierarchicalAStar large_hpa(large, octileDistance, LARGE_CLUSTER_SIZE);
+    build_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    Cell blocked = {LARGE_SIZE / 2, LARGE_SIZE / 2};
+    large.setObstacle(blocked.x, blocked.y, true);
+    start = chrono::steady_clock::now();
+    large_hpa.updateObstacles(vector<Cell>(1, blocked));
+    update_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << LARGE_SIZE << "x" << LARGE_SIZE << ", clusters of " << LARGE_CLUSTER_SIZE << ": build " << build_time
+         << "s, update after 1 blocked cell: " << update_time << "s" << endl;
+}
+
+// A robot walks its planned route and discovers obstacles on the path
+// ahead. Each discovery is handled by D* Lite repair and, for comparison,
+// by a full A* replan from the robot's current cell.
+void runReplanningComparison() {
+    const int GRID_SIZE = 512;
+    const int STEPS_BETWEEN_EVENTS = 5;
+    const int OBSTACLES_PER_EVENT = 3;
+    const int LOOKAHEAD = 20;
+    const double OBSTACLE_RATIO = 0.2;
+
+    random_device rd;
+    mt19937 gen(rd());
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO);
+    DStarLite dstar(grid, chebyshevDistance);
+    AStar astar(grid, chebyshevDistance);
+
+    auto start = chrono::steady_clock::now();
+    bool found = dstar.findPath(grid.start, grid.goal);
+    double initial_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double repair_total = 0, repair_max = 0, replan_total = 0, replan_max = 0;
+    long long repair_expanded = 0, replan_expanded = 0;
+    int events = 0, mismatches = 0;
+    Cell robot = grid.start;
+    while (found && !(robot == grid.goal)) {
+        const vector<Cell>& route = dstar.getPath();
+        size_t steps = min<size_t>(STEPS_BETWEEN_EVENTS, route.size() - 1);
+        robot = route[steps];
+        if (robot == grid.goal) break;
+        dstar.moveStart(robot);
+
+        // Block cells a little further along the current route
+        vector<Cell> discovered;
+        if (steps + 2 < route.size()) {
+            uniform_int_distribution<size_t> ahead(steps + 1, min(route.size() - 2, steps + LOOKAHEAD));
+            for (int i = 0; i < OBSTACLES_PER_EVENT; ++i) {
+                Cell cell = route[ahead(gen)];
+                if (find(discovered.begin(), discovered.end(), cell) == discovered.end()) discovered.push_back(cell);
+            }
+        }
+
+        start = chrono::steady_clock::now();
+        found = dstar.applyChanges(discovered);
+        double repair = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        bool replanned = astar.findPath(robot, grid.goal);
+        double replan = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if (replanned != found || (found && fabs(astar.getPathCost() - dstar.getPathCost()) > 1e-6)) mismatches++;
+        repair_total += repair;
+        replan_total += replan;
+        repair_max = max(repair_max, repair);
+        replan_max = max(replan_max, replan);
+        repair_expanded += dstar.getNodesExpanded();
+        replan_expanded += astar.getNodesExpanded();
+        events++;
+    }
+
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", initial D* Lite plan " << initial_time << "s, "
+         << events << " discovery events (cost mismatches " << mismatches << ")" << endl;
+    if (events > 0) {
+        cout << "  D* Lite repair: mean " << repair_total / events << "s, max " << repair_max
+             << "s, " << repair_expanded / events << " nodes" << endl;
+        cout << "  A* full replan: mean " << replan_total / events << "s, max " << replan_max
+             << "s, " << replan_expanded / events << " nodes" << endl;
+    }
+}
+
+// Landmark (ALT) heuristic against the plain Chebyshev distance: build
+// and load cost of the table, then expansions and time per query.
+void runLandmarkComparison() {
+    const int GRID_SIZE = 1024;
+    const int NUM_LANDMARKS = 8;
+    const int NUM_QUERIES = 50;
+    const double OBSTACLE_RATIO = 0.3;
+    const char* TABLE_FILE = "landmarks.bin";
+
+    random_device rd;
+    mt19937 gen(rd());
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO);
+
+    LandmarkTable built;
+    auto start = chrono::steady_clock::now();
+    built.build(grid, NUM_LANDMARKS);
+    double build_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!built.save(TABLE_FILE)) {
+        cout << "could not write " << TABLE_FILE << endl;
+        return;
+    }
+
+    LandmarkTable table;
+    start = chrono::steady_clock::now();
+    bool loaded = table.load(TABLE_FILE, grid);
+    double load_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!loaded) {
+        cout << "could not map " << TABLE_FILE << endl;
+        return;
+    }
+
+    AStar plain(grid, chebyshevDistance);
+    AStar alt(grid, table.heuristic());
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+    double plain_time = 0, alt_time = 0;
+    long long plain_expanded = 0, alt_expanded = 0;
+    int mismatches = 0;
+    for (const PathQuery& query : queries) {
+        grid.start = query.start;
+        grid.goal = query.goal;
+        bool plain_found, alt_found;
+        int expanded;
+        plain_time += timeQuery(plain, grid, plain_found, expanded);
+        plain_expanded += expanded;
+        alt_time += timeQuery(alt, grid, alt_found, expanded);
+        alt_expanded += expanded;
+        if (plain_found != alt_found || fabs(plain.getPathCost() - alt.getPathCost()) > 1e-6) mismatches++;
+    }
+
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", " << table.landmarkCount() << " landmarks, table "
+         << table.memoryBytes() / 1024 << " KiB" << endl;
+    cout << "  build: " << build_time << "s, mapped load: " << load_time << "s" << endl;
+    cout << "  Chebyshev: " << plain_time / NUM_QUERIES << "s/query, " << plain_expanded / NUM_QUERIES << " nodes" << endl;
+    cout << "  ALT:       " << alt_time / NUM_QUERIES << "s/query, " << alt_expanded / NUM_QUERIES
+         << " nodes (cost mismatches " << mismatches << ")" << endl;
+}
+
+// Function-pointer AStar against the specialized solvers picked through
+// makePathfinder, on the same 8-connected queries, followed by the time of
+// every neighborhood with its tightest heuristic.
+void runSpecializationComparison() {
+    const int GRID_SIZE = 1024;
+    const int NUM_QUERIES = 30;
+    const double OBSTACLE_RATIO = 0.3;
+
+    random_device rd;
+    mt19937 gen(rd());
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+
+    const char* names[] = {"manhattan", "euclidean", "chebyshev", "octile"};
+    HeuristicFunction functions[] = {manhattanDistance, euclideanDistance, chebyshevDistance, octileDistance};
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", " << NUM_QUERIES << " queries, 8-connected" << endl;
+    for (int h = 0; h < 4; ++h) {
+        AStar pointer(grid, functions[h]);
+        unique_ptr<AnyPathfinder> specialized = makePathfinder(grid, names[h], "8");
+        double pointer_time = 0, specialized_time = 0;
+        int mismatches = 0;
+        for (const PathQuery& query : queries) {
+            grid.start = query.start;
+            grid.goal = query.goal;
+            bool pointer_found, specialized_found;
+            int pointer_expanded, specialized_expanded;
+            pointer_time += timeQuery(pointer, grid, pointer_found, pointer_expanded);
+            specialized_time += timeQuery(*specialized, grid, specialized_found, specialized_expanded);
+            if (pointer_found != specialized_found || pointer_expanded != specialized_expanded ||
+                fabs(pointer.getPathCost() - specialized->getPathCost()) > 1e-9) {
+                mismatches++;
+            }
+        }
+        cout << "  " << names[h] << ": function pointer " << pointer_time / NUM_QUERIES << "s/query, specialized "
+             << specialized_time / NUM_QUERIES << "s/query, speedup " << pointer_time / specialized_time
+             << " (mismatches " << mismatches << ")" << endl;
+    }
+
+    const char* neighborhoods[] = {"4", "8", "8-no-corners"};
+    const char* tightest[] = {"manhattan", "octile", "octile"};
+    for (int n = 0; n < 3; ++n) {
+        unique_ptr<AnyPathfinder> solver = makePathfinder(grid, tightest[n], neighborhoods[n]);
+        double total = 0, cost = 0;
+        long long expanded_total = 0;
+        for (const PathQuery& query : queries) {
+            grid.start = query.start;
+            grid.goal = query.goal;
+            bool found;
+            int expanded;
+            total += timeQuery(*solver, grid, found, expanded);
+            expanded_total += expanded;
+            if (found) cost += solver->getPathCost();
+        }
+        cout << "  neighborhood " << neighborhoods[n] << " + " << tightest[n] << ": " << total / NUM_QUERIES << "s/query, "
+             << expanded_total / NUM_QUERIES << " nodes, mean cost " << cost / NUM_QUERIES << endl;
+    }
+}
+
+// Runs a map file through both loaders. With no arguments a random map is
+// written as a MovingAI .map first. The map is read into a Grid, converted
+// to the tiled format and mapped back, and the same queries are timed on
+// the Grid and on the mapped view. A .scen file supplies the queries and
+// reference lengths; otherwise random queries are used.
+void runMapLoading(int argc, char* argv[]) {
+    const int GENERATED_SIZE = 2048;
+    const int MAX_QUERIES = 100;
+    const char* TILED_FILE = "map.tiles";
+
+    random_device rd;
+    mt19937 gen(rd());
+    string map_file = argc > 2 ? argv[2] : "generated.map";
+    if (argc <= 2) {
+        Grid generated = generateRandomGrid(GENERATED_SIZE, GENERATED_SIZE, 0.3);
+        if (!saveMovingAIMap(map_file, generated)) {
+            cout << "could not write " << map_file << endl;
+            return;
+        }
+    }
+
+    Grid grid(0, 0);
+    auto start = chrono::steady_clock::now();
+    if (!loadMovingAIMap(map_file, grid)) {
+        cout << "could not read " << map_file << endl;
+        return;
+    }
+    double parse_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!saveTiledMap(TILED_FILE, grid)) {
+        cout << "could not write " << TILED_FILE << endl;
+        return;
+    }
+    TiledMap tiled;
+    start = chrono::steady_clock::now();
+    if (!tiled.open(TILED_FILE)) {
+        cout << "could not map " << TILED_FILE << endl;
+        return;
+    }
+    double map_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<PathQuery> queries;
+    vector<double> reference;
+    vector<ScenarioEntry> scenario;
+    if (argc > 3 && loadMovingAIScenario(argv[3], scenario)) {
+        for (size_t i = 0; i < scenario.size() && static_cast<int>(queries.size()) < MAX_QUERIES; ++i) {
+            PathQuery query = {scenario[i].start, scenario[i].goal};
+            queries.push_back(query);
+            reference.push_back(scenario[i].optimal_length);
+        }
+    } else {
+        queries = randomQueries(grid, MAX_QUERIES, gen);
+    }
+
+    // MovingAI scenarios assume no corner cutting
+    BasicAStar<QuaternaryHeapOpenList, Octile, EightConnectedNoCornerCutting> on_grid(grid);
+    BasicAStar<QuaternaryHeapOpenList, Octile, EightConnectedNoCornerCutting, TiledMap> on_tiles(tiled);
+    double grid_time = 0, tiled_time = 0, max_error = 0;
+    int mismatches = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        start = chrono::steady_clock::now();
+        bool grid_found = on_grid.findPath(queries[i].start, queries[i].goal);
+        grid_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        bool tiled_found = on_tiles.findPath(queries[i].start, queries[i].goal);
+        tiled_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (grid_found != tiled_found || on_grid.getPathCost() != on_tiles.getPathCost()) mismatches++;
+        if (grid_found && !reference.empty()) {
+            max_error = max(max_error, fabs(on_grid.getPathCost() - reference[i]) / max(reference[i], 1.0));
+        }
+    }
+
+    int count = max<int>(queries.size(), 1);
+    cout << map_file << ": " << grid.width << "x" << grid.height << ", parsed in " << parse_time << "s, "
+         << TILED_FILE << " (" << tiled.fileBytes() / 1024 << " KiB) mapped in " << map_time << "s" << endl;
+    cout << "  Grid:     " << grid_time / count << "s/query" << endl;
+    cout << "  TiledMap: " << tiled_time / count << "s/query (mismatches " << mismatches << ")" << endl;
+    if (!reference.empty()) cout << "  max relative error vs scenario lengths: " << max_error << endl;
+}
+
+vector<string> splitList(const string& text) {
+    vector<string> items;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = text.find(',', begin);
+        if (end == string::npos) end = text.size();
+        if (end > begin) items.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return items;
+}
+
+// Reproducible latency benchmark. Options (all optional):
+//   --sizes 256,1024,4096,8192   square random maps, 30% obstacles
+//   --seed N                     map and query seed (maps use seed + size)
+//   --map file.map --scen file.scen   a scenario workload instead
+//   --solvers astar,jps,bidir,hpa
+//   --heuristics manhattan,euclidean,chebyshev,octile   (for astar)
+//   --queries N --warmup N --repeats N
+//   --out benchmark_data.csv --label name
+void runBenchmarkSuite(int argc, char* argv[]) {
+    vector<int> sizes = {256, 1024, 4096, 8192};
+    uint32_t seed = 1;
+    string map_file, scen_file;
+    vector<string> solvers = {"astar", "jps", "bidir"};
+    vector<string> heuristics = {"manhattan", "euclidean", "chebyshev", "octile"};
+    int num_queries = 20, warmup = 2, repeats = 3;
+    string out_file = "benchmark_data.csv", label = "current";
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string flag = argv[i], value = argv[i + 1];
+        if (flag == "--sizes") {
+            sizes.clear();
+            for (const string& item : splitList(value)) sizes.push_back(atoi(item.c_str()));
+        } else if (flag == "--seed") seed = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+        else if (flag == "--map") map_file = value;
+        else if (flag == "--scen") scen_file = value;
+        else if (flag == "--solvers") solvers = splitList(value);
+        else if (flag == "--heuristics") heuristics = splitList(value);
+        else if (flag == "--queries") num_queries = atoi(value.c_str());
+        else if (flag == "--warmup") warmup = atoi(value.c_str());
+        else if (flag == "--repeats") repeats = atoi(value.c_str());
+        else if (flag == "--out") out_file = value;
+        else if (flag == "--label") label = value;
+        else {
+            cout << "unknown option " << flag << endl;
+            return;
+        }
+    }
+
+    vector<BenchmarkResult> results;
+    int num_workloads = map_file.empty() ? sizes.size() : 1;
+    for (int w = 0; w < num_workloads; ++w) {
+        Grid grid(0, 0);
+        vector<PathQuery> queries;
+        string workload = "random";
+        if (map_file.empty()) {
+            grid = generateRandomGrid(sizes[w], sizes[w], 0.3, seed + sizes[w]);
+            mt19937 gen(seed);
+            queries = randomQueries(grid, num_queries, gen);
+        } else {
+            vector<ScenarioEntry> scenario;
+            if (!loadMovingAIMap(map_file, grid) || !loadMovingAIScenario(scen_file, scenario)) {
+                cout << "could not read " << map_file << " / " << scen_file << endl;
+                return;
+            }
+            for (size_t i = 0; i < scenario.size() && static_cast<int>(queries.size()) < num_queries; ++i) {
+                PathQuery query = {scenario[i].start, scenario[i].goal};
+                queries.push_back(query);
+            }
+            workload = map_file;
+        }
+
+        for (const string& solver_name : solvers) {
+            vector<BenchmarkResult> measured;
+            vector<string> used;
+            if (solver_name == "astar") {
+                for (const string& heuristic : heuristics) {
+                    unique_ptr<AnyPathfinder> solver = makePathfinder(grid, heuristic, "8");
+                    if (!solver) continue;
+                    measured.push_back(measureQueries(*solver, queries.data(), queries.size(), warmup, repeats));
+                    used.push_back(heuristic);
+                }
+            } else if (solver_name == "jps") {
+                JumpPointSearch solver(grid, octileDistance);
+                measured.push_back(measureQueries(solver, queries.data(), queries.size(), warmup, repeats));
+                used.push_back("octile");
+            } else if (solver_name == "bidir") {
+                BidirectionalAStar solver(grid, octileDistance);
+                measured.push_back(measureQueries(solver, queries.data(), queries.size(), warmup, repeats));
+                used.push_back("octile");
+            } else if (solver_name == "hpa") {
+                HierarchicalAStar solver(grid, octileDistance);
+                measured.push_back(measureQueries(solver, queries.data(), queries.size(), warmup, repeats));
+                used.push_back("octile");
+            } else {
+                cout << "unknown solver " << solver_name << endl;
+                continue;
+            }
+
+            for (size_t i = 0; i < measured.size(); ++i) {
+                BenchmarkResult& result = measured[i];
+                result.workload = workload;
+                result.width = grid.width;
+                result.height = grid.height;
+                result.seed = seed;
+                result.solver = solver_name;
+                result.heuristic = used[i];
+                cout << grid.width << "x" << grid.height << " " << solver_name << "/" << used[i]
+                     << ": p50 " << result.p50_ns / 1e3 << "us, p95 " << result.p95_ns / 1e3 << "us, p99 "
+                     << result.p99_ns / 1e3 << "us, " << result.queries_per_second << " queries/s, "
+                     << result.solved << "/" << result.queries << " solved" << endl;
+                results.push_back(result);
+            }
+        }
+    }
+
+    if (writeBenchmarkCsv(out_file, label, results)) {
+        cout << "Benchmark data saved to " << out_file << endl;
+    } else {
+        cout << "could not write " << out_file << endl;
+    }
+}
+
+// Search-loop counters of A* with each open list. Needs a build with
+// -DASTAR_ENABLE_STATS; hardware counters also need perf_event access.
+void runInstrumentedQueries() {
+#ifdef ASTAR_ENABLE_STATS
+    const int GRID_SIZE = 1024;
+    const int NUM_QUERIES = 5;
+    const double OBSTACLE_RATIO = 0.3;
+
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO, 7);
+    mt19937 gen(7);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+    BasicAStar<QuaternaryHeapOpenList, Euclidean> quaternary(grid);
+    BasicAStar<BucketOpenList, Euclidean> bucket(grid);
+    bool hardware = quaternary.enableHardwareCounters() && bucket.enableHardwareCounters();
+    if (!hardware) cout << "hardware counters unavailable (perf_event_open refused)" << endl;
+
+    for (const PathQuery& query : queries) {
+        quaternary.findPath(query.start, query.goal);
+        bucket.findPath(query.start, query.goal);
+        const SearchStats* all[] = {&quaternary.getStats(), &bucket.getStats()};
+        const char* names[] = {"4-ary heap", "buckets"};
+        for (int i = 0; i < 2; ++i) {
+            const SearchStats& stats = *all[i];
+            cout << names[i] << ": pushes " << stats.pushes << ", pops " << stats.pops << ", decrease-keys "
+                 << stats.decrease_keys << ", reopenings " << stats.reopenings << ", neighbors "
+                 << stats.neighbors_generated << " (" << stats.neighbors_rejected << " rejected, "
+                 << stats.neighbors_blocked << " blocked), peak open " << stats.peak_open << ", peak closed "
+                 << stats.peak_closed << endl;
+            cout << "  time " << stats.total_ns / 1000 << "us: open list " << stats.open_list_ns / 1000
+                 << "us, neighbors " << stats.neighbors_ns / 1000 << "us";
+            if (stats.hardware_counters) {
+                cout << "; " << stats.cycles << " cycles, IPC " << double(stats.instructions) / max<uint64_t>(stats.cycles, 1)
+                     << ", " << stats.llc_misses << " LLC misses";
+            }
+            cout << endl;
+        }
+    }
+#else
+    cout << "rebuild with -DASTAR_ENABLE_STATS to collect search statistics" << endl;
+#endif
+}
+
+// Bitboard floods: a reachability check in front of A* on a map dense
+// enough to have many closed-off pockets, and the BFS distance field
+// against a cell-by-cell queue BFS.
+void runBitboardComparison() {
+    const int GRID_SIZE = 2048;
+    const int NUM_QUERIES = 100;
+    const double OBSTACLE_RATIO = 0.5;
+
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO, 11);
+    mt19937 gen(11);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+    BitboardFlood flood(grid);
+    BasicAStar<QuaternaryHeapOpenList, Octile> astar(grid);
+
+    // Times split by whether the pair turned out to be connected
+    double astar_time[2] = {0, 0}, check_time[2] = {0, 0};
+    int pairs[2] = {0, 0}, mismatches = 0;
+    for (const PathQuery& query : queries) {
+        auto start = chrono::steady_clock::now();
+        bool found = astar.findPath(query.start, query.goal);
+        double astar_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        bool reachable = flood.reachable(query.start, query.goal);
+        double check_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        astar_time[reachable] += astar_seconds;
+        check_time[reachable] += check_seconds;
+        pairs[reachable]++;
+        mismatches += reachable != found;
+    }
+
+    auto start = chrono::steady_clock::now();
+    vector<int> field;
+    flood.distanceField(grid.start, field);
+    double field_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    vector<int> reference(grid.width * grid.height, -1);
+    queue<Cell> frontier;
+    reference[grid.start.y * grid.width + grid.start.x] = 0;
+    frontier.push(grid.start);
+    while (!frontier.empty()) {
+        Cell cell = frontier.front();
+        frontier.pop();
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                Cell next = {cell.x + dx, cell.y + dy};
+                int key = next.y * grid.width + next.x;
+                if (grid.isObstacle(next.x, next.y) || reference[key] >= 0) continue;
+                reference[key] = reference[cell.y * grid.width + cell.x] + 1;
+                frontier.push(next);
+            }
+        }
+    }
+    double queue_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+#ifdef __AVX2__
+    const char* kernel = "AVX2";
+#else
+    const char* kernel = "scalar";
+#endif
+    cout << GRID_SIZE << "x" << GRID_SIZE << " obstacles " << OBSTACLE_RATIO << ", " << kernel << " kernel, "
+         << pairs[0] << "/" << NUM_QUERIES << " queries unreachable (mismatches " << mismatches << ")" << endl;
+    const char* kinds[] = {"unreachable", "reachable"};
+    for (int r = 0; r < 2; ++r) {
+        if (pairs[r] == 0) continue;
+        cout << "  " << kinds[r] << " pairs: reachability check " << check_time[r] / pairs[r] << "s, A* "
+             << astar_time[r] / pairs[r] << "s" << endl;
+    }
+    cout << "  distance field: bitboard " << field_time << "s, queue BFS " << queue_time << "s"
+         << (field == reference ? "" : " (fields differ)") << endl;
+}
+
+// Flow field for a fleet sharing one goal: one build plus a walk per
+// agent against one A* query per agent, then an incremental repair after
+// a few cells change against a full rebuild.
+void runFlowFieldComparison() {
+    const int GRID_SIZE = 2048;
+    const int NUM_AGENTS = 200;
+    const int NUM_CHANGES = 20;
+    const double OBSTACLE_RATIO = 0.3;
+
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO, 15);
+    mt19937 gen(15);
+    vector<PathQuery> queries = randomQueries(grid, NUM_AGENTS, gen);
+    BasicAStar<QuaternaryHeapOpenList, Octile> astar(grid);
+    FlowField serial(grid, 1);
+    FlowField parallel(grid);
+
+    auto start = chrono::steady_clock::now();
+    serial.build();
+    double serial_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    parallel.build();
+    double parallel_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double astar_time = 0, follow_time = 0;
+    int reachable = 0, mismatches = 0;
+    vector<Cell> path;
+    for (const PathQuery& query : queries) {
+        start = chrono::steady_clock::now();
+        bool found = astar.findPath(query.start, grid.goal);
+        astar_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        bool followed = parallel.followPath(query.start, path);
+        follow_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        reachable += followed;
+        if (found != followed || (found && fabs(astar.getPathCost() - parallel.getCost(query.start)) > 1e-6)) mismatches++;
+    }
+
+    // Toggle cells on the agents' routes so the repair has work to do
+    vector<Cell> changed;
+    for (int i = 0; i < NUM_AGENTS && static_cast<int>(changed.size()) < NUM_CHANGES; ++i) {
+        if (!parallel.followPath(queries[i].start, path) || path.size() < 3) continue;
+        Cell cell = path[path.size() / 2];
+        grid.setObstacle(cell.x, cell.y, true);
+        changed.push_back(cell);
+    }
+    start = chrono::steady_clock::now();
+    parallel.update(changed);
+    double update_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    serial.build();
+    double rebuild_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int field_mismatches = 0;
+    for (int y = 0; y < grid.height; ++y) {
+        for (int x = 0; x < grid.width; ++x) {
+            Cell cell = {x, y};
+            if (serial.isReachable(cell) != parallel.isReachable(cell) ||
+                serial.getCost(cell) != parallel.getCost(cell)) {
+                field_mismatches++;
+            }
+        }
+    }
+
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", " << NUM_AGENTS << " agents (" << reachable
+         << " reach the goal, cost mismatches " << mismatches << "), field "
+         << parallel.memoryBytes() / (1024 * 1024) << " MB" << endl;
+    cout << "  build: 1 thread " << serial_time << "s, " << parallel.threadCount() << " threads "
+         << parallel_time << "s" << endl;
+    cout << "  per agent: A* " << astar_time / NUM_AGENTS << "s, follow field " << follow_time / NUM_AGENTS
+         << "s" << endl;
+    cout << "  " << changed.size() << " cells blocked: update " << update_time << "s, rebuild " << rebuild_time
+         << "s (cells differing " << field_mismatches << ")" << endl;
+}
+
+// Anytime A* under per-query time budgets: how many queries have a path
+// when the budget runs out, its proven bound and its real cost against the
+// optimum, and how far the query overran its budget.
+void runAnytimeComparison() {
+    const int GRID_SIZE = 2048;
+    const int NUM_QUERIES = 50;
+    const double OBSTACLE_RATIO = 0.3;
+    const double BUDGETS_MS[] = {0.5, 2, 10, 50};
+
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO, 16);
+    mt19937 gen(16);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+    BasicAStar<QuaternaryHeapOpenList, Octile> astar(grid);
+    BasicAnytimeAStar<Octile> anytime(grid);
+
+    vector<double> optimal(NUM_QUERIES, 0);
+    double astar_time = 0, full_time = 0;
+    int reachable = 0, mismatches = 0;
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+        auto start = chrono::steady_clock::now();
+        bool found = astar.findPath(queries[i].start, queries[i].goal);
+        astar_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        optimal[i] = found ? astar.getPathCost() : 0;
+        reachable += found;
+
+        start = chrono::steady_clock::now();
+        bool completed = anytime.findPath(queries[i].start, queries[i].goal);
+        full_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (completed != found || (found && fabs(anytime.getPathCost() - optimal[i]) > 1e-6)) mismatches++;
+    }
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", " << reachable << "/" << NUM_QUERIES
+         << " queries reachable: A* " << astar_time / NUM_QUERIES << "s, ARA* to optimality "
+         << full_time / NUM_QUERIES << "s per query (cost mismatches " << mismatches << ")" << endl;
+
+    for (double budget_ms : BUDGETS_MS) {
+        chrono::nanoseconds budget(static_cast<long long>(budget_ms * 1e6));
+        int with_path = 0, optimal_paths = 0, violations = 0;
+        double bound_sum = 0, ratio_sum = 0, overrun = 0;
+        for (int i = 0; i < NUM_QUERIES; ++i) {
+            if (optimal[i] == 0) continue;
+            auto start = chrono::steady_clock::now();
+            bool found = anytime.findPath(queries[i].start, queries[i].goal, budget);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            overrun = max(overrun, seconds - budget_ms / 1000);
+            if (!found) continue;
+            with_path++;
+            optimal_paths += anytime.isFinished();
+            bound_sum += anytime.getBound();
+            ratio_sum += anytime.getPathCost() / optimal[i];
+            if (anytime.getPathCost() > anytime.getBound() * optimal[i] + 1e-6) violations++;
+        }
+        cout << "  budget " << budget_ms << "ms: " << with_path << "/" << reachable << " with a path, "
+             << optimal_paths << " proven optimal";
+        if (with_path > 0) {
+            cout << ", mean bound " << bound_sum / with_path << ", mean cost/optimal " << ratio_sum / with_path;
+        }
+        cout << ", max overrun " << max(overrun, 0.0) * 1000 << "ms (bound violations " << violations << ")"
+             << endl;
+    }
+}
+
+// Path cache on a repetitive workload: queries drawn from a small set of
+// pairs, some asking for a stretch of a route already served, with a few
+// obstacles toggled now and then. Every answer is checked against A*.
+void runPathCacheComparison() {
+    const int GRID_SIZE = 1024;
+    const int NUM_PAIRS = 100;
+    const int NUM_QUERIES = 2000;
+    const int QUERIES_BETWEEN_EDITS = 250;
+    const int CELLS_PER_EDIT = 5;
+    const double SUB_QUERY_SHARE = 0.3;
+    const double OBSTACLE_RATIO = 0.3;
+
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO, 17);
+    mt19937 gen(17);
+    vector<PathQuery> pairs = randomQueries(grid, NUM_PAIRS, gen);
+    BasicAStar<QuaternaryHeapOpenList, Octile> astar(grid);
+    BasicAStar<QuaternaryHeapOpenList, Octile> reference(grid);
+    CachedPathfinder<BasicAStar<QuaternaryHeapOpenList, Octile> > cache(astar, grid, 256);
+
+    uniform_int_distribution<> pick(0, NUM_PAIRS - 1);
+    uniform_real_distribution<> coin(0, 1);
+    double cached_time = 0, uncached_time = 0;
+    int mismatches = 0, edits = 0;
+    for (int q = 0; q < NUM_QUERIES; ++q) {
+        if (q > 0 && q % QUERIES_BETWEEN_EDITS == 0) {
+            // Toggle cells on a cached route and a few anywhere
+            vector<Cell> changed;
+            if (cache.findPath(pairs[pick(gen)].start, pairs[pick(gen)].goal) && cache.getPathLength() > 2) {
+                changed.push_back(cache.getPath()[cache.getPathLength() / 2]);
+            }
+            uniform_int_distribution<> coordinate(0, GRID_SIZE - 1);
+            while (static_cast<int>(changed.size()) < CELLS_PER_EDIT) {
+                Cell cell = {coordinate(gen), coordinate(gen)};
+                if (find(changed.begin(), changed.end(), cell) == changed.end()) changed.push_back(cell);
+            }
+            for (const Cell& cell : changed) grid.setObstacle(cell.x, cell.y, !grid.isObstacle(cell.x, cell.y));
+            cache.invalidate(changed);
+            edits++;
+        }
+
+        PathQuery query = pairs[pick(gen)];
+        if (coin(gen) < SUB_QUERY_SHARE && reference.findPath(query.start, query.goal)) {
+            const vector<Cell>& route = reference.getPath();
+            uniform_int_distribution<size_t> along(0, route.size() - 1);
+            query.start = route[along(gen)];
+            query.goal = route[along(gen)];
+        }
+
+        auto start = chrono::steady_clock::now();
+        bool found = cache.findPath(query.start, query.goal);
+        cached_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        bool expected = reference.findPath(query.start, query.goal);
+        uncached_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (found != expected || (found && fabs(cache.getPathCost() - reference.getPathCost()) > 1e-6)) mismatches++;
+    }
+
+    const PathCacheCounters& counters = cache.getCounters();
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", " << NUM_QUERIES << " queries over " << NUM_PAIRS << " pairs, "
+         << edits << " map edits (cost mismatches " << mismatches << ")" << endl;
+    cout << "  hits " << counters.hits << ", sub-path hits " << counters.sub_path_hits << ", misses "
+         << counters.misses << ", evictions " << counters.evictions << ", invalidated " << counters.invalidated
+         << endl;
+    cout << "  mean query: cached " << cached_time / NUM_QUERIES << "s, uncached " << uncached_time / NUM_QUERIES
+         << "s" << endl;
+}
+
+// Deterministic map generation: time per map type on one thread and on
+// all of them, whether both runs produced the same map, and whether start
+// and goal are connected.
+void runMapGeneration(int argc, char* argv[]) {
+    int size = argc > 2 ? atoi(argv[2]) : 4096;
+    const uint64_t SEED = 18;
+    const MapType types[] = {MAP_NOISE, MAP_ROOMS, MAP_MAZE, MAP_CAVES};
+    const char* names[] = {"noise", "rooms", "maze", "caves"};
+    const int feature_sizes[] = {0, 32, 4, 64};
+    const double ratios[] = {0.3, 0.05, 0, 0.4};
+
+    auto start = chrono::steady_clock::now();
+    generateRandomGrid(size, size, 0.3, SEED);
+    double legacy_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << size << "x" << size << ", generateRandomGrid " << legacy_time << "s" << endl;
+
+    for (int t = 0; t < 4; ++t) {
+        MapSpec spec = {types[t], size, size, SEED, ratios[t], feature_sizes[t]};
+        start = chrono::steady_clock::now();
+        Grid serial = generateMap(spec, 1);
+        double serial_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        Grid parallel = generateMap(spec);
+        double parallel_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        bool same = serial.start == parallel.start && serial.goal == parallel.goal;
+        for (int y = 0; y < size && same; ++y) {
+            same = equal(serial.rowWords(y), serial.rowWords(y) + serial.wordsPerRow(), parallel.rowWords(y));
+        }
+        BitboardFlood flood(parallel);
+        bool connected = flood.reachable(parallel.start, parallel.goal);
+        cout << "  " << names[t] << ": 1 thread " << serial_time << "s, " << thread::hardware_concurrency() << " threads "
+             << parallel_time << "s, obstacles " << static_cast<double>(parallel.countObstacles()) / size / size
+             << (same ? ", identical" : ", MAPS DIFFER") << (connected ? ", start-goal connected" : ", NOT CONNECTED")
+             << endl;
+    }
+}
+
+// Cooperative planning for fleets of 100 to 1000 agents with distinct
+// starts and goals: crossing the whole of a small map, then short trips on
+// a large one, which split into groups planned in parallel. Reports agents
+// planned per second on one thread and on all of them, groups and merge
+// rounds, collisions left in the plans, and the sum of costs against the
+// agents' shortest paths alone.
+void runCooperativePlanning() {
+    struct Scenario {
+        int grid_size;
+        int fleet;
+        int trip; // largest goal offset per axis, 0 for anywhere
+    };
+    const Scenario SCENARIOS[] = {{256, 100, 0}, {256, 250, 0}, {256, 500, 0}, {256, 1000, 0}, {1024, 1000, 32}};
+    const double OBSTACLE_RATIO = 0.2;
+
+    for (const Scenario& scenario : SCENARIOS) {
+        int size = scenario.grid_size;
+        Grid grid = generateRandomGrid(size, size, OBSTACLE_RATIO, 19);
+        FlowField component(grid, 1);
+        component.build();
+
+        // Distinct starts and goals, all in the component of grid.goal
+        mt19937 gen(scenario.fleet);
+        uniform_int_distribution<> offset(-scenario.trip, scenario.trip);
+        vector<PathQuery> agents;
+        vector<char> used_start(size * size, 0), used_goal(size * size, 0);
+        while (static_cast<int>(agents.size()) < scenario.fleet) {
+            PathQuery query = randomQueries(grid, 1, gen)[0];
+            if (scenario.trip) query.goal = {query.start.x + offset(gen), query.start.y + offset(gen)};
+            if (!grid.isValidCell(query.goal.x, query.goal.y) || query.start == query.goal) continue;
+            int start_key = query.start.y * size + query.start.x, goal_key = query.goal.y * size + query.goal.x;
+            if (used_start[start_key] || used_goal[goal_key]) continue;
+            if (!component.isReachable(query.start) || !component.isReachable(query.goal)) continue;
+            used_start[start_key] = used_goal[goal_key] = 1;
+            agents.push_back(query);
+        }
+
+        CooperativePlanner serial(grid, 1);
+        auto start = chrono::steady_clock::now();
+        serial.plan(agents);
+        double serial_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        CooperativePlanner parallel(grid);
+        start = chrono::steady_clock::now();
+        int solved = parallel.plan(agents);
+        double parallel_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        BasicAStar<QuaternaryHeapOpenList, Octile> astar(grid);
+        double alone_cost = 0;
+        for (int i = 0; i < scenario.fleet; ++i) {
+            if (!parallel.isSolved(i)) continue;
+            astar.findPath(agents[i].start, agents[i].goal);
+            alone_cost += astar.getPathCost();
+        }
+
+        cout << size << "x" << size << ", " << scenario.fleet << " agents"
+             << (scenario.trip ? " on short trips: " : ": ") << solved << " planned, " << parallel.getGroupCount()
+             << " groups after " << parallel.getMergeRounds() << " merge rounds, " << parallel.countConflicts()
+             << " collisions" << endl;
+        cout << "  1 thread " << scenario.fleet / serial_time << " agents/s, " << parallel.threadCount()
+             << " threads " << scenario.fleet / parallel_time << " agents/s, " << parallel.getNodesExpanded()
+             << " nodes expanded" << endl;
+        cout << "  makespan " << parallel.getMakespan() << ", sum of costs " << parallel.getSumOfCosts()
+             << " (shortest paths alone " << alone_cost << ")" << endl;
+    }
+}
+
+// Copy-on-write map snapshots: A* on a snapshot against A* on the Grid it
+// came from, then reader threads answering queries while a writer
+// publishes obstacle edits, with every path checked against the version it
+// was planned on.
+void runSnapshotComparison() {
+    const int GRID_SIZE = 1024;
+    const int NUM_QUERIES = 200;
+    const int NUM_PUBLISHES = 200;
+    const int EDITS_PER_PUBLISH = 16;
+    const double OBSTACLE_RATIO = 0.3;
+
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO, 20);
+    mt19937 gen(20);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+    MapStore store(grid);
+
+    BasicAStar<QuaternaryHeapOpenList, Octile> on_grid(grid);
+    SnapshotSolver<BasicAStar<QuaternaryHeapOpenList, Octile, EightConnected, MapSnapshot> > on_snapshot(store);
+    double grid_time = 0, snapshot_time = 0;
+    int mismatches = 0;
+    for (const PathQuery& query : queries) {
+        auto start = chrono::steady_clock::now();
+        bool expected = on_grid.findPath(query.start, query.goal);
+        grid_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        bool found = on_snapshot.findPath(query.start, query.goal);
+        snapshot_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (found != expected || fabs(on_snapshot.getPathCost() - on_grid.getPathCost()) > 1e-6) mismatches++;
+    }
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", " << NUM_QUERIES << " queries (cost mismatches " << mismatches
+         << "), " << store.current()->tileCount() << " tiles" << endl;
+    cout << "  mean query: Grid " << grid_time / NUM_QUERIES << "s, snapshot " << snapshot_time / NUM_QUERIES
+         << "s" << endl;
+
+    // Readers loop over the queries until the writer is done
+    int num_readers = max(2, static_cast<int>(thread::hardware_concurrency()));
+    atomic<bool> writing(true);
+    atomic<long long> answered(0), invalid(0);
+    set<uint64_t> versions_seen;
+    mutex versions_mutex;
+    vector<thread> readers;
+    for (int r = 0; r < num_readers; ++r) {
+        readers.push_back(thread([&, r]() {
+            SnapshotSolver<BasicAStar<QuaternaryHeapOpenList, Octile, EightConnected, MapSnapshot> > solver(store);
+            set<uint64_t> seen;
+            for (size_t q = r; writing; q = (q + 1) % queries.size()) {
+                bool found = solver.findPath(queries[q].start, queries[q].goal);
+                const MapSnapshot& map = *solver.getMap();
+                for (const Cell& cell : solver.getPath()) {
+                    if (found && map.isObstacle(cell.x, cell.y)) {
+                        invalid++;
+                        break;
+                    }
+                }
+                seen.insert(map.getVersion());
+                answered++;
+            }
+            lock_guard<mutex> lock(versions_mutex);
+            versions_seen.insert(seen.begin(), seen.end());
+        }));
+    }
+
+    uniform_int_distribution<> coordinate(0, GRID_SIZE - 1);
+    double publish_time = 0;
+    size_t copied_tiles = 0;
+    auto start = chrono::steady_clock::now();
+    for (int p = 0; p < NUM_PUBLISHES; ++p) {
+        vector<ObstacleEdit> edits;
+        for (int e = 0; e < EDITS_PER_PUBLISH; ++e) {
+            ObstacleEdit edit = {{coordinate(gen), coordinate(gen)}, gen() % 2 == 0};
+            edits.push_back(edit);
+        }
+        MapHandle before = store.current();
+        auto publish_start = chrono::steady_clock::now();
+        MapHandle after = store.publish(edits);
+        publish_time += chrono::duration<double>(chrono::steady_clock::now() - publish_start).count();
+        copied_tiles += after->tileCount() - after->sharedTiles(*before);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    writing = false;
+    for (thread& reader : readers) reader.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "  " << num_readers << " readers: " << answered / elapsed << " queries/s over " << versions_seen.size()
+         << " map versions, " << invalid << " paths through obstacles of their version" << endl;
+    cout << "  " << NUM_PUBLISHES << " publishes of " << EDITS_PER_PUBLISH << " edits: mean "
+         << publish_time / NUM_PUBLISHES << "s, " << static_cast<double>(copied_tiles) / NUM_PUBLISHES
+         << " tiles copied each (Grid copy " << grid.memoryBytes() / 1024 << " KB, tile "
+         << sizeof(MapSnapshot::Tile) << " B)" << endl;
+}
+
+// Memory-bounded A* under budgets of 100% down to 10% of the memory the
+// same search needs unbounded: queries solved within the budget, peak
+// bytes held, and expansions against A* (the cost of regenerating dropped
+// nodes). Every path found is checked against A*'s cost.
+void runMemoryBoundedComparison() {
+    typedef BasicMemoryBoundedAStar<Octile> BoundedAStar;
+    const int GRID_SIZE = 512;
+    const int NUM_QUERIES = 20;
+    const double OBSTACLE_RATIO = 0.3;
+    const double BUDGET_SHARES[] = {1.0, 0.5, 0.25, 0.1};
+    const long long EXPANSION_FACTOR = 100; // give up at this many times A*'s expansions
+
+    Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO, 21);
+    mt19937 gen(21);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+    BasicAStar<QuaternaryHeapOpenList, Octile> astar(grid);
+    BoundedAStar unbounded(grid, static_cast<size_t>(GRID_SIZE) * GRID_SIZE * BoundedAStar::bytesPerNode());
+
+    vector<double> optimal(NUM_QUERIES, 0);
+    vector<int> expansions(NUM_QUERIES, 0);
+    vector<size_t> needed(NUM_QUERIES, 0);
+    double astar_time = 0, unbounded_time = 0;
+    int reachable = 0;
+    size_t most_needed = 0;
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+        auto start = chrono::steady_clock::now();
+        bool found = astar.findPath(queries[i].start, queries[i].goal);
+        astar_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (!found) continue;
+        optimal[i] = astar.getPathCost();
+        expansions[i] = astar.getNodesExpanded();
+        reachable++;
+
+        start = chrono::steady_clock::now();
+        unbounded.findPath(queries[i].start, queries[i].goal);
+        unbounded_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        needed[i] = unbounded.getPeakBytes();
+        most_needed = max(most_needed, needed[i]);
+    }
+    cout << GRID_SIZE << "x" << GRID_SIZE << ", " << reachable << "/" << NUM_QUERIES << " queries reachable: A* "
+         << astar_time / NUM_QUERIES << "s, unbounded SMA* " << unbounded_time / max(reachable, 1)
+         << "s per query, peak search memory up to " << most_needed / 1024 << " KB ("
+         << BoundedAStar::bytesPerNode() << " B per node)" << endl;
+
+    for (double share : BUDGET_SHARES) {
+        int solved = 0, mismatches = 0, over_budget = 0;
+        long long bounded_expansions = 0, astar_expansions = 0, dropped = 0;
+        size_t peak = 0;
+        double elapsed = 0;
+        for (int i = 0; i < NUM_QUERIES; ++i) {
+            if (optimal[i] == 0) continue;
+            BoundedAStar bounded(grid, static_cast<size_t>(share * needed[i]));
+            bounded.setExpansionLimit(EXPANSION_FACTOR * expansions[i]);
+            auto start = chrono::steady_clock::now();
+            bool found = bounded.findPath(queries[i].start, queries[i].goal);
+            elapsed += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (bounded.getReservedBytes() > bounded.getBudgetBytes()) over_budget++;
+            if (!found) continue;
+            solved++;
+            if (fabs(bounded.getPathCost() - optimal[i]) > 1e-6) mismatches++;
+            bounded_expansions += bounded.getNodesExpanded();
+            astar_expansions += expansions[i];
+            dropped += bounded.getNodesDropped();
+            peak = max(peak, bounded.getPeakBytes());
+        }
+        cout << "  budget " << share * 100 << "% of unbounded: " << solved << "/" << reachable << " solved";
+        if (solved > 0) {
+            cout << ", expansions x" << static_cast<double>(bounded_expansions) / astar_expansions << " of A*, "
+                 << dropped / solved << " nodes dropped per query, peak " << peak / 1024 << " KB";
+        }
+        cout << ", " << elapsed / reachable << "s per query (cost mismatches " << mismatches << ", over budget "
+             << over_budget << ")" << endl;
+    }
+}
+
+// Hash-distributed A* on one corner-to-corner query of a large noise map
+// (4096x4096 unless a size is given, e.g. 16384) with 1 to 64 workers:
+// time and speedup against A* and against one worker, total expansions
+// (search overhead), nodes sent to other workers and load balance.
+void runParallelSearch(int argc, char* argv[]) {
+    int size = argc > 2 ? atoi(argv[2]) : 4096;
+    const int THREAD_COUNTS[] = {1, 2, 4, 8, 16, 32, 64};
+
+    MapSpec spec = {MAP_NOISE, size, size, 22, 0.3, 0};
+    Grid grid = generateMap(spec);
+    // Free cells nearest the two far corners that are connected
+    BitboardFlood flood(grid);
+    Cell start = {0, 0}, goal = {size - 1, size - 1};
+    for (int d = 0; d < size; ++d) {
+        start.x = start.y = d;
+        if (!grid.isObstacle(d, d)) break;
+    }
+    for (int d = size - 1; d >= 0; --d) {
+        goal.x = goal.y = d;
+        if (!grid.isObstacle(d, d) && flood.reachable(start, goal)) break;
+    }
+
+    BasicAStar<QuaternaryHeapOpenList, Octile> astar(grid);
+    auto begin = chrono::steady_clock::now();
+    bool found = astar.findPath(start, goal);
+    double astar_time = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    cout << size << "x" << size << ", (" << start.x << "," << start.y << ") to (" << goal.x << "," << goal.y
+         << "): A* " << astar_time << "s, " << astar.getNodesExpanded() << " expansions, cost "
+         << (found ? astar.getPathCost() : 0) << " (" << thread::hardware_concurrency() << " hardware threads)"
+         << endl;
+
+    double single_time = 0;
+    for (int threads : THREAD_COUNTS) {
+        ParallelAStar hda(grid, threads);
+        begin = chrono::steady_clock::now();
+        bool hda_found = hda.findPath(start, goal);
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        if (threads == 1) single_time = elapsed;
+        bool matches = hda_found == found && (!found || fabs(hda.getPathCost() - astar.getPathCost()) < 1e-6);
+        size_t smallest, largest;
+        hda.getTableSizes(smallest, largest);
+        cout << "  " << threads << " threads: " << elapsed << "s, speedup x" << astar_time / elapsed << " over A*, x"
+             << single_time / elapsed << " over 1 thread, expansions x"
+             << static_cast<double>(hda.getNodesExpanded()) / max(astar.getNodesExpanded(), 1) << ", "
+             << static_cast<double>(hda.getNodesSent()) / max(hda.getNodesExpanded(), 1)
+             << " nodes sent per expansion, cells per worker " << smallest << "-" << largest
+             << (matches ? "" : " (COST MISMATCH)") << endl;
+    }
+}
+
+// Compressed path database on a rooms map (128x128 unless a size is
+// given): build time on every hardware thread, size against one byte per
+// source/target pair, mapped load, then lookups against A* on the same
+// queries with their costs checked.
+void runPathDatabase(int argc, char* argv[]) {
+    int size = argc > 2 ? atoi(argv[2]) : 128;
+    const int NUM_QUERIES = 1000;
+    const char* DATABASE_FILE = "paths.cpd";
+
+    MapSpec spec = {MAP_ROOMS, size, size, 23, 0.1, 16};
+    Grid grid = generateMap(spec);
+    PathDatabase built;
+    auto start = chrono::steady_clock::now();
+    built.build(grid);
+    double build_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!built.save(DATABASE_FILE)) {
+        cout << "could not write " << DATABASE_FILE << endl;
+        return;
+    }
+
+    PathDatabase database;
+    start = chrono::steady_clock::now();
+    bool loaded = database.load(DATABASE_FILE, grid);
+    double load_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!loaded) {
+        cout << "could not map " << DATABASE_FILE << endl;
+        return;
+    }
+
+    long long free_cells = static_cast<long long>(size) * size - grid.countObstacles();
+    cout << size << "x" << size << " rooms, " << free_cells << " free cells, " << database.runCount() << " runs ("
+         << static_cast<double>(database.runCount()) / free_cells << " per source), "
+         << database.memoryBytes() / 1024 << " KiB against " << free_cells * free_cells / 1024
+         << " KiB uncompressed" << endl;
+    cout << "  build: " << build_time << "s on " << thread::hardware_concurrency()
+         << " hardware threads, mapped load: " << load_time << "s" << endl;
+
+    mt19937 gen(23);
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+    AStar astar(grid, octileDistance);
+    double astar_time = 0, lookup_time = 0;
+    long long steps = 0;
+    int mismatches = 0;
+    for (const PathQuery& query : queries) {
+        grid.start = query.start;
+        grid.goal = query.goal;
+        bool astar_found, found;
+        int expanded;
+        astar_time += timeQuery(astar, grid, astar_found, expanded);
+        lookup_time += timeQuery(database, grid, found, expanded);
+        steps += database.getPathLength();
+        if (astar_found != found || fabs(astar.getPathCost() - database.getPathCost()) > 1e-6) mismatches++;
+    }
+    cout << "  A*:     " << astar_time / NUM_QUERIES * 1e6 << " us/query" << endl;
+    cout << "  lookup: " << lookup_time / NUM_QUERIES * 1e6 << " us/query, "
+         << lookup_time / max(steps, 1LL) * 1e9 << " ns/step (cost mismatches " << mismatches << ")" << endl;
+}
+
+// Grid seen by a round robot, checked the direct way: every cell under
+// the footprint on every lookup
+struct FootprintView {
+    const Grid* grid;
+    int reach;
+    double radius_squared;
+    Cell start, goal;
+    int width, height;
+
+    bool isObstacle(int x, int y) const {
+        if (!grid->isValidCell(x, y)) return true;
+        for (int dy = -reach; dy <= reach; ++dy) {
+            for (int dx = -reach; dx <= reach; ++dx) {
+                if (dx * dx + dy * dy <= radius_squared && grid->isObstacle(x + dx, y + dy)) return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Clearance map of a caves map (1024x1024 unless a size is given): build
+// on one and on every hardware thread, incremental updates after small
+// edits against full rebuilds, then A* for robots of radius 0 to 3 through
+// the clearance map against checking the whole footprint per lookup.
+void runClearanceMap(int argc, char* argv[]) {
+    int size = argc > 2 ? atoi(argv[2]) : 1024;
+    const double MAX_RADIUS = 3;
+    const int NUM_EDITS = 200;
+    const int NUM_QUERIES = 10;
+
+    MapSpec spec = {MAP_CAVES, size, size, 24, 0.35, 24};
+    Grid grid = generateMap(spec);
+    ClearanceMap single(grid, MAX_RADIUS, 1);
+    ClearanceMap clearance(grid, MAX_RADIUS);
+    auto start = chrono::steady_clock::now();
+    single.build();
+    double single_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    clearance.build();
+    double build_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << size << "x" << size << " caves, clearance map " << clearance.memoryBytes() / 1024 << " KiB" << endl;
+    cout << "  build: " << single_time << "s on 1 thread, " << build_time << "s on " << clearance.threadCount()
+         << " threads" << endl;
+
+    // Small clusters of flipped cells, as when a shelf is moved
+    mt19937 gen(24);
+    uniform_int_distribution<> coord(0, size - 4);
+    double update_time = 0;
+    for (int i = 0; i < NUM_EDITS; ++i) {
+        vector<Cell> changed;
+        int x = coord(gen), y = coord(gen);
+        for (int k = 0; k < 4; ++k) {
+            Cell cell = {x + k, y + k % 2};
+            grid.setObstacle(cell.x, cell.y, !grid.isObstacle(cell.x, cell.y));
+            changed.push_back(cell);
+        }
+        start = chrono::steady_clock::now();
+        clearance.update(changed);
+        update_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    single.build();
+    int differing = 0;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) differing += single.squaredClearance(x, y) != clearance.squaredClearance(x, y);
+    }
+    cout << "  update after a 4-cell edit: " << update_time / NUM_EDITS * 1e6 << " us (cells differing from a rebuild: "
+         << differing << ")" << endl;
+
+    vector<PathQuery> queries = randomQueries(grid, NUM_QUERIES, gen);
+    for (int radius = 0; radius <= MAX_RADIUS; ++radius) {
+        ClearanceView view(grid, clearance, radius);
+        FootprintView footprint = {&grid, radius, double(radius) * radius, grid.start, grid.goal, size, size};
+        BasicAStar<QuaternaryHeapOpenList, Octile, EightConnected, ClearanceView> fast(view);
+        BasicAStar<QuaternaryHeapOpenList, Octile, EightConnected, FootprintView> direct(footprint);
+        double fast_time = 0, direct_time = 0;
+        int solved = 0, mismatches = 0;
+        for (const PathQuery& query : queries) {
+            if (view.isObstacle(query.start.x, query.start.y) || view.isObstacle(query.goal.x, query.goal.y)) continue;
+            start = chrono::steady_clock::now();
+            bool fast_found = fast.findPath(query.start, query.goal);
+            fast_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            start = chrono::steady_clock::now();
+            bool direct_found = direct.findPath(query.start, query.goal);
+            direct_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            solved += fast_found;
+            if (fast_found != direct_found || fabs(fast.getPathCost() - direct.getPathCost()) > 1e-6) mismatches++;
+        }
+        cout << "  radius " << radius << ": " << solved << " paths, clearance map " << fast_time
+             << "s, footprint check " << direct_time << "s (mismatches " << mismatches << ")" << endl;
+    }
+}
+
+// Map served by the serve and loadgen modes, which must agree on it
+Grid serverMap(int argc, char* argv[]) {
+    int size = argc > 3 ? atoi(argv[3]) : 512;
+    MapSpec spec = {MAP_ROOMS, size, size, 25, 0.1, 16};
+    return generateMap(spec);
+}
+
+// Pathfinding server on a Unix socket (/tmp/astar_solver.sock unless a
+// path is given) for a rooms map (512x512 unless a size follows); runs
+// until killed.
+void runPathServer(int argc, char* argv[]) {
+    string socket_path = argc > 2 ? argv[2] : "/tmp/astar_solver.sock";
+    Grid grid = serverMap(argc, argv);
+    PathServer server(grid);
+    if (!server.listen(socket_path)) {
+        cout << "could not listen on " << socket_path << " (Unix domain sockets and epoll need Linux)" << endl;
+        return;
+    }
+    cout << "serving " << grid.width << "x" << grid.height << " on " << socket_path << " with "
+         << server.threadCount() << " threads" << endl;
+    server.run();
+}
+
+// Load generator for the server mode, with the same arguments. Without a
+// server at the socket it starts one in this process. Throughput and
+// latency percentiles for 1 to 64 pipelining clients.
+void runLoadGenerator(int argc, char* argv[]) {
+    string socket_path = argc > 2 ? argv[2] : "/tmp/astar_solver.sock";
+    const int CLIENT_COUNTS[] = {1, 4, 16, 64};
+    const int DEPTH = 8;
+    const int QUERIES_PER_RUN = 8000;
+
+    Grid grid = serverMap(argc, argv);
+    mt19937 gen(25);
+    vector<PathQuery> queries = randomQueries(grid, 1000, gen);
+
+    unique_ptr<PathServer> local;
+    thread server_thread;
+    LoadReport report;
+    if (!runPathLoad(socket_path, queries, 1, 1, 1, report)) {
+        local.reset(new PathServer(grid));
+        if (!local->listen(socket_path)) {
+            cout << "could not reach or start a server on " << socket_path << " (needs Linux)" << endl;
+            return;
+        }
+        server_thread = thread([&] { local->run(); });
+        cout << "started a server in this process with " << local->threadCount() << " threads" << endl;
+    }
+
+    cout << grid.width << "x" << grid.height << " rooms, " << DEPTH << " requests in flight per client" << endl;
+    for (int clients : CLIENT_COUNTS) {
+        long long batches = local ? local->getBatches() : 0;
+        if (!runPathLoad(socket_path, queries, clients, DEPTH, QUERIES_PER_RUN / clients, report)) {
+            cout << "  " << clients << " clients: could not connect" << endl;
+            continue;
+        }
+        cout << "  " << clients << " clients: " << report.queries / report.seconds << " queries/s, latency p50 "
+             << report.p50_us << " us, p99 " << report.p99_us << " us, p99.9 " << report.p999_us << " us";
+        if (local) cout << ", " << static_cast<double>(report.queries) / max(local->getBatches() - batches, 1LL) << " per batch";
+        cout << " (unreachable " << report.unreachable << ", wrong " << report.wrong << ")" << endl;
+    }
+
+    if (local) {
+        local->stop();
+        server_thread.join();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "openlists") {
+        runOpenListComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "jps") {
+        runJumpPointComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "batch") {
+        runBatchComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "bidir") {
+        runBidirectionalComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "hpa") {
+        runHierarchicalComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "replan") {
+        runReplanningComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "alt") {
+        runLandmarkComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "specialized") {
+        runSpecializationComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "maps") {
+        runMapLoading(argc, argv);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "bench") {
+        runBenchmarkSuite(argc, argv);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "stats") {
+        runInstrumentedQueries();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "bitboard") {
+        runBitboardComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "flow") {
+        runFlowFieldComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "anytime") {
+        runAnytimeComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "cache") {
+        runPathCacheComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "generate") {
+        runMapGeneration(argc, argv);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "coop") {
+        runCooperativePlanning();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "snapshot") {
+        runSnapshotComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "bounded") {
+        runMemoryBoundedComparison();
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "parallel") {
+        runParallelSearch(argc, argv);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "pathdb") {
+        runPathDatabase(argc, argv);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "clearance") {
+        runClearanceMap(argc, argv);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "serve") {
+        runPathServer(argc, argv);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "loadgen") {
+        runLoadGenerator(argc, argv);
+        return 0;
+    }
+
     const int NUM_RUNS = 50;
     const int GRID_SIZE = 50;
     const double OBSTACLE_RATIO = 0.3;
+    const uint32_t SEED = 2024;
     
     ofstream data_file("performance_data.csv");
+    data_file.precision(12);
     data_file << "Run,Heuristic,TimeTaken,PathLength,NodesExpanded,PathFound\n";
     
-    random_device rd;
-    mt19937 gen(rd());
-    
     vector<HeuristicFunction> heuristics = {
         manhattanDistance,
         euclideanDistance,
@@ -58,7 +1778,7 @@ int main() {
     for (int run = 0; run < NUM_RUNS; ++run) {
         cout << "Running test " << run + 1 << "/" << NUM_RUNS << endl;
         
-        Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO);
+        Grid grid = generateRandomGrid(GRID_SIZE, GRID_SIZE, OBSTACLE_RATIO, SEED + run);
         
         for (size_t i = 0; i < heuristics.size(); ++i) {
             PerformanceMetrics metrics = runAStarForHeuristic(grid, heuristics[i], heuristic_names[i]);
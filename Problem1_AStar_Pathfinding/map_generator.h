@@ -0,0 +1,344 @@
+#ifndef MAP_GENERATOR_H
+#define MAP_GENERATOR_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "grid_generator.h"
+#include "thread_pool.h"
+
+// Deterministic, parallel map generation for large test maps. Every random
+// choice is a hash of (seed, stream, counter) instead of the next draw of
+// a sequential generator, so any cell can be computed on its own: rows are
+// filled by all threads at once, 64 cells per write, and the result depends
+// only on the spec, not on the thread count.
+//
+// Start and goal are always connected: the start is the sampled free cell
+// with the largest component (a few samples), the goal a random other cell
+// of that component.
+enum MapType {
+    MAP_NOISE, // independent obstacles with probability obstacle_ratio
+    MAP_ROOMS, // square rooms of feature_size cells joined by doors, plus clutter
+    MAP_MAZE,  // perfect maze with corridors feature_size cells wide
+    MAP_CAVES  // smooth value noise cut at the obstacle_ratio quantile
+};
+
+struct MapSpec {
+    MapType type;
+    int width;
+    int height;
+    uint64_t seed;
+    double obstacle_ratio; // noise and caves: share of rock; rooms: clutter
+    int feature_size;      // rooms, maze, caves; ignored for noise
+};
+
+// SplitMix64 finalizer: a strong 64-bit bijective mixer
+inline uint64_t mixBits(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Key of one random stream of a seed
+inline uint64_t streamKey(uint64_t seed, uint64_t stream) {
+    return mixBits(seed ^ mixBits(stream));
+}
+
+// Counter-based random value (SplitMix64 indexed by counter): the same key
+// and counter always give the same bits
+inline uint64_t counterHash(uint64_t key, uint64_t counter) {
+    return mixBits(key + (counter + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+// Random streams, one per kind of decision
+enum {
+    STREAM_NOISE,
+    STREAM_DOORS,
+    STREAM_MAZE,
+    STREAM_CAVES,       // one stream per noise octave
+    STREAM_CAVE_DETAIL,
+    STREAM_CAVE_SAMPLES,
+    STREAM_ENDPOINTS,
+    STREAM_COUNT
+};
+
+class MapGenerator {
+private:
+    const MapSpec& spec;
+    int period;                     // rooms and maze: feature_size + 1 wall
+    uint32_t noise_threshold;       // noise and clutter, on 16-bit samples
+    double cave_threshold;
+    uint64_t keys[STREAM_COUNT];
+
+    uint64_t random(int stream, uint64_t counter) const {
+        return counterHash(keys[stream], counter);
+    }
+
+    // Obstacle bits of cells x0 .. x0 + 63 of row y (x0 a multiple of 64).
+    // Each hash holds 16-bit samples for four cells.
+    uint64_t noiseWord(int x0, int y) const {
+        uint64_t value = 0;
+        uint64_t counter = (static_cast<uint64_t>(y) * ((spec.width + 63) / 64) + x0 / 64) * 16;
+        for (int i = 0; i < 16; ++i) {
+            uint64_t bits = random(STREAM_NOISE, counter + i);
+            for (int k = 0; k < 4; ++k) {
+                if (((bits >> (16 * k)) & 0xFFFF) < noise_threshold) value |= uint64_t(1) << (4 * i + k);
+            }
+        }
+        return value;
+    }
+
+    // Rooms: walls on every period-th row and column, and one door per
+    // wall between neighbouring rooms, so all full rooms are connected.
+    // Inside a room the cell keeps its clutter bit.
+    bool roomsBlocked(int x, int y, bool clutter) const {
+        int size = spec.feature_size;
+        int rx = x / period, ox = x % period;
+        int ry = y / period, oy = y % period;
+        int door = std::max(1, size / 4);
+        uint64_t room = static_cast<uint64_t>(ry) * (spec.width / period + 1) + rx;
+        if (ox == size && oy == size) return true;
+        if (ox == size) {
+            int offset = random(STREAM_DOORS, 2 * room) % (size - door + 1);
+            return oy < offset || oy >= offset + door;
+        }
+        if (oy == size) {
+            int offset = random(STREAM_DOORS, 2 * room + 1) % (size - door + 1);
+            return ox < offset || ox >= offset + door;
+        }
+        return clutter;
+    }
+
+    // Sidewinder maze: each maze row is carved from hashes of that row
+    // alone. The first row is one corridor; in every other row a run of
+    // cells joined eastwards ends at random and opens one passage north.
+    // `east` and `north` receive the openings of maze row `row`.
+    void mazeRow(int row, int columns, std::vector<uint8_t>& east, std::vector<uint8_t>& north) const {
+        east.assign(columns, 0);
+        north.assign(columns, 0);
+        int run_start = 0;
+        for (int column = 0; column < columns; ++column) {
+            uint64_t bits = random(STREAM_MAZE, static_cast<uint64_t>(row) * columns + column);
+            bool carve_east = column + 1 < columns && (row == 0 || (bits & 1));
+            east[column] = carve_east;
+            if (!carve_east && row > 0) {
+                north[run_start + (bits >> 1) % (column - run_start + 1)] = 1;
+                run_start = column + 1;
+            }
+        }
+    }
+
+    // Maze cells are feature_size wide with one-cell walls; a wall column
+    // is open where the row's run continues east, a wall row where the
+    // maze row below opens north
+    void fillMazeRow(Grid& grid, int y, std::vector<uint8_t>& east, std::vector<uint8_t>& north) const {
+        int size = spec.feature_size;
+        int columns = (spec.width + 1) / period, rows = (spec.height + 1) / period;
+        int row = y / period, oy = y % period;
+        if (oy < size && row < rows) mazeRow(row, columns, east, north);
+        else if (oy == size && row + 1 < rows) mazeRow(row + 1, columns, east, north);
+        for (int x0 = 0; x0 < spec.width; x0 += 64) {
+            uint64_t value = 0;
+            for (int i = 0; i < 64 && x0 + i < spec.width; ++i) {
+                int x = x0 + i, column = x / period, ox = x % period;
+                bool open = false;
+                if (row < rows && column < columns) {
+                    if (oy < size) open = ox < size || east[column];
+                    else open = ox < size && row + 1 < rows && north[column];
+                }
+                if (!open) value |= uint64_t(1) << i;
+            }
+            grid.setRowBits(y, x0, value);
+        }
+    }
+
+    // Value noise in [0, 1]: hashed lattice values, smoothly interpolated,
+    // at wavelengths feature_size and feature_size / 2
+    double caveNoise(int x, int y) const {
+        double total = 0, weight = 0, amplitude = 1;
+        for (int octave = 0, wavelength = spec.feature_size; octave < 2 && wavelength >= 2;
+             ++octave, wavelength /= 2, amplitude *= 0.5) {
+            int lx = x / wavelength, ly = y / wavelength;
+            double fx = static_cast<double>(x % wavelength) / wavelength;
+            double fy = static_cast<double>(y % wavelength) / wavelength;
+            fx = fx * fx * (3 - 2 * fx);
+            fy = fy * fy * (3 - 2 * fy);
+            double corners[4];
+            for (int c = 0; c < 4; ++c) {
+                uint64_t lattice = (static_cast<uint64_t>(ly + (c >> 1)) << 32) | static_cast<uint32_t>(lx + (c & 1));
+                uint64_t bits = random(STREAM_CAVES + octave, lattice);
+                corners[c] = (bits >> 11) * (1.0 / 9007199254740992.0); // top 53 bits in [0, 1)
+            }
+            double top = corners[0] + (corners[1] - corners[0]) * fx;
+            double bottom = corners[2] + (corners[3] - corners[2]) * fx;
+            total += amplitude * (top + (bottom - top) * fy);
+            weight += amplitude;
+        }
+        return weight > 0 ? total / weight : 0;
+    }
+
+    // Noise value below which a cell is rock, from a fixed sample of cells
+    double caveThreshold() const {
+        const int SAMPLES = 1 << 16;
+        std::vector<double> values(SAMPLES);
+        for (int i = 0; i < SAMPLES; ++i) {
+            uint64_t bits = random(STREAM_CAVE_SAMPLES, i);
+            values[i] = caveNoise(static_cast<int>((bits & 0xFFFFFFFF) % spec.width),
+                                  static_cast<int>((bits >> 32) % spec.height));
+        }
+        size_t rank = std::min<size_t>(SAMPLES - 1, static_cast<size_t>(spec.obstacle_ratio * SAMPLES));
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values[rank];
+    }
+
+    void fillRow(Grid& grid, int y, std::vector<uint8_t>* scratch) const {
+        if (spec.type == MAP_MAZE) {
+            fillMazeRow(grid, y, scratch[0], scratch[1]);
+            return;
+        }
+        for (int x0 = 0; x0 < spec.width; x0 += 64) {
+            uint64_t value = spec.type == MAP_CAVES ? 0 : noiseWord(x0, y);
+            if (spec.type != MAP_NOISE) {
+                for (int i = 0; i < 64 && x0 + i < spec.width; ++i) {
+                    int x = x0 + i;
+                    bool blocked;
+                    if (spec.type == MAP_ROOMS) blocked = roomsBlocked(x, y, (value >> i) & 1);
+                    else blocked = caveNoise(x, y) < cave_threshold;
+                    value = blocked ? value | (uint64_t(1) << i) : value & ~(uint64_t(1) << i);
+                }
+            }
+            grid.setRowBits(y, x0, value);
+        }
+    }
+
+    // Marks the cells reachable from source in `visited` (one bit per cell
+    // key) and returns how many there are. Scanline flood: each seed fills
+    // its whole free run of the row, then seeds one cell of every free run
+    // touching it (diagonals included) in the rows above and below.
+    size_t flood(const Grid& grid, const Cell& source, std::vector<uint64_t>& visited) const {
+        visited.assign((static_cast<size_t>(spec.width) * spec.height + 63) / 64, 0);
+        struct Visited {
+            std::vector<uint64_t>& bits;
+            size_t width;
+            bool operator()(int x, int y) const {
+                size_t key = y * width + x;
+                return (bits[key >> 6] >> (key & 63)) & 1;
+            }
+        } seen = {visited, static_cast<size_t>(spec.width)};
+
+        std::vector<Cell> stack(1, source);
+        size_t count = 0;
+        while (!stack.empty()) {
+            Cell seed = stack.back();
+            stack.pop_back();
+            if (seen(seed.x, seed.y)) continue;
+            int y = seed.y, left = seed.x, right = seed.x;
+            while (!grid.isObstacle(left - 1, y) && !seen(left - 1, y)) left--;
+            while (!grid.isObstacle(right + 1, y) && !seen(right + 1, y)) right++;
+            for (int x = left; x <= right; ++x) {
+                size_t key = static_cast<size_t>(y) * spec.width + x;
+                visited[key >> 6] |= uint64_t(1) << (key & 63);
+            }
+            count += right - left + 1;
+
+            for (int ny = y - 1; ny <= y + 1; ny += 2) {
+                if (ny < 0 || ny >= spec.height) continue;
+                bool in_run = false;
+                for (int x = std::max(left - 1, 0); x <= std::min(right + 1, spec.width - 1); ++x) {
+                    bool open = !grid.isObstacle(x, ny) && !seen(x, ny);
+                    if (open && !in_run) {
+                        Cell next = {x, ny};
+                        stack.push_back(next);
+                    }
+                    in_run = open;
+                }
+            }
+        }
+        return count;
+    }
+
+    void placeEndpoints(Grid& grid) const {
+        const int CANDIDATES = 8;
+        const int ATTEMPTS = 4096;
+        size_t free_cells = static_cast<size_t>(spec.width) * spec.height - grid.countObstacles();
+        grid.start.x = grid.start.y = 0;
+        grid.goal = grid.start;
+        if (free_cells == 0) return;
+
+        // Start: the sampled free cell with the largest component
+        std::vector<uint64_t> visited, best_visited;
+        size_t best_size = 0;
+        uint64_t counter = 0;
+        for (int candidate = 0; candidate < CANDIDATES && best_size * 2 < free_cells; ++candidate) {
+            Cell start = {0, 0};
+            bool found = false;
+            for (int attempt = 0; attempt < ATTEMPTS && !found; ++attempt) {
+                uint64_t bits = random(STREAM_ENDPOINTS, counter++);
+                start.x = static_cast<int>((bits & 0xFFFFFFFF) % spec.width);
+                start.y = static_cast<int>((bits >> 32) % spec.height);
+                found = !grid.isObstacle(start.x, start.y);
+            }
+            if (!found) break;
+            size_t size = flood(grid, start, visited);
+            if (size > best_size) {
+                best_size = size;
+                grid.start = start;
+                best_visited.swap(visited);
+            }
+        }
+        if (best_size == 0) return;
+
+        // Goal: a random other cell of the same component
+        size_t rank = best_size > 1 ? random(STREAM_ENDPOINTS, counter) % (best_size - 1) : 0;
+        size_t start_key = static_cast<size_t>(grid.start.y) * spec.width + grid.start.x;
+        for (size_t word = 0; word < best_visited.size(); ++word) {
+            uint64_t bits = best_visited[word];
+            if (word == start_key >> 6) bits &= ~(uint64_t(1) << (start_key & 63));
+            size_t count = __builtin_popcountll(bits);
+            if (rank >= count) {
+                rank -= count;
+                continue;
+            }
+            for (; rank > 0; --rank) bits &= bits - 1;
+            size_t key = word * 64 + __builtin_ctzll(bits);
+            grid.goal.x = static_cast<int>(key % spec.width);
+            grid.goal.y = static_cast<int>(key / spec.width);
+            return;
+        }
+        grid.goal = grid.start;
+    }
+
+public:
+    explicit MapGenerator(const MapSpec& s) : spec(s), period(std::max(2, s.feature_size) + 1), cave_threshold(0) {
+        double ratio = std::min(std::max(spec.obstacle_ratio, 0.0), 1.0);
+        noise_threshold = static_cast<uint32_t>(ratio * 65536);
+        for (int stream = 0; stream < STREAM_COUNT; ++stream) keys[stream] = streamKey(spec.seed, stream);
+        if (spec.type == MAP_CAVES) cave_threshold = caveThreshold();
+    }
+
+    Grid generate(int num_threads) const {
+        Grid grid(spec.width, spec.height);
+        ThreadPool pool(num_threads);
+        int workers = pool.size();
+        // Each worker fills a band of rows; rows share no words
+        pool.run([&](int worker) {
+            std::vector<uint8_t> scratch[2];
+            int end = static_cast<int>(static_cast<long long>(spec.height) * (worker + 1) / workers);
+            for (int y = static_cast<int>(static_cast<long long>(spec.height) * worker / workers); y < end; ++y) {
+                fillRow(grid, y, scratch);
+            }
+        });
+        placeEndpoints(grid);
+        return grid;
+    }
+};
+
+// feature_size must be at least 2 for rooms and mazes. num_threads <= 0
+// uses every hardware thread; the map is the same for any thread count.
+Grid generateMap(const MapSpec& spec, int num_threads = 0) {
+    MapSpec checked = spec;
+    if (checked.type != MAP_NOISE) checked.feature_size = std::max(2, checked.feature_size);
+    return MapGenerator(checked).generate(num_threads);
+}
+
+#endif
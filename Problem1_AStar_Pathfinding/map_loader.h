@@ -0,0 +1,108 @@
+#ifndef MAP_LOADER_H
+#define MAP_LOADER_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "grid_generator.h"
+
+// Readers and writers for the MovingAI benchmark formats
+// (https://movingai.com/benchmarks/formats.html).
+//
+// A .map file is a short header followed by one text row per map row:
+//   type octile
+//   height <h>
+//   width <w>
+//   map
+// '.', 'G' and 'S' are passable; '@', 'O', 'T' and 'W' are blocked.
+//
+// A .scen file lists queries for a map, one per line after "version 1":
+//   bucket map width height start_x start_y goal_x goal_y optimal_length
+// The optimal lengths assume sqrt(2) diagonals and no corner cutting, so
+// they match EightConnectedNoCornerCutting up to the 1.414 rounding.
+
+struct ScenarioEntry {
+    int bucket;
+    std::string map;
+    int map_width;
+    int map_height;
+    Cell start;
+    Cell goal;
+    double optimal_length;
+};
+
+// Replaces grid with the map in path. Start and goal are both set to the
+// first free cell; scenario files supply the real queries. Returns false
+// if the file cannot be read or is malformed.
+bool loadMovingAIMap(const std::string& path, Grid& grid) {
+    std::ifstream in(path.c_str());
+    if (!in) return false;
+
+    int width = -1, height = -1;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        fields >> name;
+        if (name == "height") fields >> height;
+        else if (name == "width") fields >> width;
+        else if (name == "map") break;
+    }
+    if (width <= 0 || height <= 0) return false;
+
+    Grid loaded(width, height);
+    bool first_free = true;
+    for (int y = 0; y < height; ++y) {
+        if (!std::getline(in, line)) return false;
+        if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        if (static_cast<int>(line.size()) < width) return false;
+        for (int x = 0; x < width; ++x) {
+            char c = line[x];
+            bool passable = c == '.' || c == 'G' || c == 'S';
+            loaded.setObstacle(x, y, !passable);
+            if (passable && first_free) {
+                loaded.start = loaded.goal = Cell{x, y};
+                first_free = false;
+            }
+        }
+    }
+    if (first_free) loaded.start = loaded.goal = Cell{0, 0};
+    grid = loaded;
+    return true;
+}
+
+bool saveMovingAIMap(const std::string& path, const Grid& grid) {
+    std::ofstream out(path.c_str());
+    if (!out) return false;
+    out << "type octile\nheight " << grid.height << "\nwidth " << grid.width << "\nmap\n";
+    std::string row(grid.width, '.');
+    for (int y = 0; y < grid.height; ++y) {
+        for (int x = 0; x < grid.width; ++x) {
+            row[x] = grid.isObstacle(x, y) ? '@' : '.';
+        }
+        out << row << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+// Appends the queries in path to entries
+bool loadMovingAIScenario(const std::string& path, std::vector<ScenarioEntry>& entries) {
+    std::ifstream in(path.c_str());
+    if (!in) return false;
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 7, "version") != 0) return false;
+    while (std::getline(in, line)) {
+        if (line.empty() || line == "\r") continue;
+        std::istringstream fields(line);
+        ScenarioEntry entry;
+        if (!(fields >> entry.bucket >> entry.map >> entry.map_width >> entry.map_height >> entry.start.x >>
+              entry.start.y >> entry.goal.x >> entry.goal.y >> entry.optimal_length)) {
+            return false;
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef MAP_SNAPSHOT_H
+#define MAP_SNAPSHOT_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include "grid_generator.h"
+
+struct ObstacleEdit {
+    Cell cell;
+    bool blocked;
+};
+
+// One immutable version of a map, cut into 64x64 tiles of one 64-bit word
+// per tile row. Tiles are reference counted and shared with the versions
+// before and after, so publishing an edit copies only the tiles it touches.
+// A snapshot never changes once published: any number of threads may read
+// it without synchronisation while newer versions are being built. It has
+// the start/goal/width/height/isObstacle interface of Grid, so it can be
+// the MapT of BasicAStar. Cells outside the map read as blocked.
+class MapSnapshot {
+public:
+    static const int TILE_EDGE = 64;
+
+    struct Tile {
+        uint64_t rows[TILE_EDGE];
+    };
+
+private:
+    std::vector<std::shared_ptr<const Tile> > tiles;
+    std::vector<const uint64_t*> tile_rows; // tiles[i]->rows, read on every lookup
+    int tiles_x;
+    uint64_t version;
+
+    friend class MapStore;
+
+    MapSnapshot() : tiles_x(0), version(0), width(0), height(0) {}
+
+    int tileIndex(int x, int y) const {
+        return (y / TILE_EDGE) * tiles_x + x / TILE_EDGE;
+    }
+
+public:
+    Cell start;
+    Cell goal;
+    int width, height;
+
+    bool isValidCell(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+
+    bool isObstacle(int x, int y) const {
+        if (static_cast<unsigned>(x) >= static_cast<unsigned>(width) ||
+            static_cast<unsigned>(y) >= static_cast<unsigned>(height)) {
+            return true;
+        }
+        return (tile_rows[tileIndex(x, y)][y % TILE_EDGE] >> (x % TILE_EDGE)) & 1;
+    }
+
+    uint64_t getVersion() const {
+        return version;
+    }
+
+    // Tiles this version shares with `other` (same storage, not just equal)
+    size_t sharedTiles(const MapSnapshot& other) const {
+        size_t shared = 0;
+        for (size_t i = 0; i < tiles.size() && i < other.tiles.size(); ++i) shared += tiles[i] == other.tiles[i];
+        return shared;
+    }
+
+    size_t tileCount() const {
+        return tiles.size();
+    }
+
+    // A mutable copy, for the solvers that only take a Grid
+    Grid toGrid() const {
+        Grid grid(width, height);
+        grid.start = start;
+        grid.goal = goal;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; x += TILE_EDGE) {
+                grid.setRowBits(y, x, tile_rows[tileIndex(x, y)][y % TILE_EDGE]);
+            }
+        }
+        return grid;
+    }
+};
+
+const int MapSnapshot::TILE_EDGE;
+
+typedef std::shared_ptr<const MapSnapshot> MapHandle;
+
+// Holds the current version of a map. Readers call current() once per
+// query and search the snapshot it returns, which stays alive as long as
+// they hold the handle, however many versions are published meanwhile.
+// publish() builds the next version from the current one by copying only
+// the edited tiles, then swaps it in atomically; writers are serialised.
+class MapStore {
+private:
+    MapHandle head; // only accessed through std::atomic_load/atomic_store
+    std::mutex writer;
+
+public:
+    explicit MapStore(const Grid& grid) {
+        std::shared_ptr<MapSnapshot> snapshot(new MapSnapshot());
+        snapshot->width = grid.width;
+        snapshot->height = grid.height;
+        snapshot->start = grid.start;
+        snapshot->goal = grid.goal;
+        snapshot->tiles_x = (grid.width + MapSnapshot::TILE_EDGE - 1) / MapSnapshot::TILE_EDGE;
+        int tiles_y = (grid.height + MapSnapshot::TILE_EDGE - 1) / MapSnapshot::TILE_EDGE;
+        for (int ty = 0; ty < tiles_y; ++ty) {
+            for (int tx = 0; tx < snapshot->tiles_x; ++tx) {
+                std::shared_ptr<MapSnapshot::Tile> tile(new MapSnapshot::Tile());
+                for (int row = 0; row < MapSnapshot::TILE_EDGE; ++row) {
+                    int y = ty * MapSnapshot::TILE_EDGE + row;
+                    // rowBits() reads past-the-edge columns and the bottom border as blocked
+                    tile->rows[row] = grid.rowBits(std::min(y, grid.height), tx * MapSnapshot::TILE_EDGE);
+                }
+                snapshot->tile_rows.push_back(tile->rows);
+                snapshot->tiles.push_back(tile);
+            }
+        }
+        head = snapshot;
+    }
+
+    MapHandle current() const {
+        return std::atomic_load(&head);
+    }
+
+    // Applies the edits on top of the current version and publishes the
+    // result as the next version, which is returned. Edits outside the
+    // map are ignored.
+    MapHandle publish(const std::vector<ObstacleEdit>& edits) {
+        std::lock_guard<std::mutex> lock(writer);
+        MapHandle base = current();
+        std::shared_ptr<MapSnapshot> next(new MapSnapshot(*base));
+        next->version = base->version + 1;
+
+        std::unordered_map<int, MapSnapshot::Tile*> copied; // tile index -> this version's copy
+        for (size_t i = 0; i < edits.size(); ++i) {
+            const Cell& cell = edits[i].cell;
+            if (!base->isValidCell(cell.x, cell.y)) continue;
+            int index = base->tileIndex(cell.x, cell.y);
+            MapSnapshot::Tile*& tile = copied[index];
+            if (!tile) {
+                std::shared_ptr<MapSnapshot::Tile> copy(new MapSnapshot::Tile(*base->tiles[index]));
+                tile = copy.get();
+                next->tiles[index] = copy;
+                next->tile_rows[index] = copy->rows;
+            }
+            uint64_t mask = uint64_t(1) << (cell.x % MapSnapshot::TILE_EDGE);
+            uint64_t& row = tile->rows[cell.y % MapSnapshot::TILE_EDGE];
+            row = edits[i].blocked ? (row | mask) : (row & ~mask);
+        }
+
+        MapHandle published = next;
+        std::atomic_store(&head, published);
+        return published;
+    }
+};
+
+// A solver with setMap() (BasicAStar<..., MapSnapshot>) that searches the
+// store's latest version on every query. The handle it pins keeps that
+// version alive until the next query, so getPath() stays valid, and
+// getMap() tells which version the answer belongs to.
+template <class Solver>
+class SnapshotSolver {
+private:
+    const MapStore& store;
+    MapHandle map;
+    Solver solver;
+
+public:
+    template <class... Args>
+    explicit SnapshotSolver(const MapStore& s, Args... args) : store(s), map(s.current()), solver(*map, args...) {}
+
+    bool findPath(const Cell& start, const Cell& goal) {
+        MapHandle latest = store.current();
+        if (latest != map) {
+            map = latest;
+            solver.setMap(*map);
+        }
+        return solver.findPath(start, goal);
+    }
+
+    const MapHandle& getMap() const {
+        return map;
+    }
+
+    int getPathLength() const {
+        return solver.getPathLength();
+    }
+
+    double getPathCost() const {
+        return solver.getPathCost();
+    }
+
+    int getNodesExpanded() const {
+        return solver.getNodesExpanded();
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return solver.getPath();
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef NEIGHBORHOODS_H
+#define NEIGHBORHOODS_H
+
+#include "grid_generator.h"
+
+// Movement models for the templated solvers. expand() writes the free
+// neighbors of a cell and the cost of stepping to each, and returns how
+// many there are (at most MAX_NEIGHBORS). The map is a Grid or any type
+// with the same isObstacle(), which must report the cells just outside the
+// map as blocked, so no bounds checks are needed here.
+
+// Straight moves only, cost 1
+struct FourConnected {
+    static const int MAX_NEIGHBORS = 4;
+
+    template <class MapT>
+    static int expand(const MapT& grid, const Cell& cell, Cell* neighbors, double* costs) {
+        static const int dx[] = {-1, 1, 0, 0};
+        static const int dy[] = {0, 0, -1, 1};
+        int count = 0;
+        for (int i = 0; i < 4; ++i) {
+            Cell next = {cell.x + dx[i], cell.y + dy[i]};
+            if (!grid.isObstacle(next.x, next.y)) {
+                neighbors[count] = next;
+                costs[count++] = 1.0;
+            }
+        }
+        return count;
+    }
+};
+
+// Straight and diagonal moves; a diagonal may squeeze between two blocked
+// cells. This is the model of the original AStar, JPS and HPA*.
+struct EightConnected {
+    static const int MAX_NEIGHBORS = 8;
+
+    template <class MapT>
+    static int expand(const MapT& grid, const Cell& cell, Cell* neighbors, double* costs) {
+        static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
+        int count = 0;
+        for (int i = 0; i < 8; ++i) {
+            Cell next = {cell.x + dx[i], cell.y + dy[i]};
+            if (!grid.isObstacle(next.x, next.y)) {
+                neighbors[count] = next;
+                costs[count++] = i < 4 ? 1.0 : 1.414;
+            }
+        }
+        return count;
+    }
+};
+
+// Diagonal moves only when both cells they pass are free, so paths never
+// clip an obstacle's corner
+struct EightConnectedNoCornerCutting {
+    static const int MAX_NEIGHBORS = 8;
+
+    template <class MapT>
+    static int expand(const MapT& grid, const Cell& cell, Cell* neighbors, double* costs) {
+        bool west = !grid.isObstacle(cell.x - 1, cell.y);
+        bool east = !grid.isObstacle(cell.x + 1, cell.y);
+        bool north = !grid.isObstacle(cell.x, cell.y - 1);
+        bool south = !grid.isObstacle(cell.x, cell.y + 1);
+        bool open[] = {west, east, north, south,
+                       west && north, west && south, east && north, east && south};
+        static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+        static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
+        int count = 0;
+        for (int i = 0; i < 8; ++i) {
+            Cell next = {cell.x + dx[i], cell.y + dy[i]};
+            if (open[i] && (i < 4 || !grid.isObstacle(next.x, next.y))) {
+                neighbors[count] = next;
+                costs[count++] = i < 4 ? 1.0 : 1.414;
+            }
+        }
+        return count;
+    }
+};
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef OPEN_LIST_H
+#define OPEN_LIST_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "lazy_array.h"
+
+// Open lists for the grid solvers. Every implementation offers the same
+// interface, keyed by cell key:
+//   reset(num_keys)  size for keys in [0, num_keys) and empty the list
+//   empty(), size()
+//   push(key, f)     key must not be in the list
+//   decrease(key, f) key must be in the list with a priority >= f
+//   pop()            remove and return a key with the lowest priority
+
+// d-ary min-heap with a position table, giving O(log n) decrease-key.
+// Priority only needs operator<, so solvers can order by composite keys.
+template <class Priority, int Arity = 4>
+class IndexedHeap {
+private:
+    struct Entry {
+        Priority priority;
+        int key;
+    };
+
+    std::vector<Entry> heap;
+    LazyArray<int> positions;
+
+    void place(int index, const Entry& entry) {
+        heap[index] = entry;
+        positions[entry.key] = index;
+    }
+
+    void siftUp(int index) {
+        Entry entry = heap[index];
+        while (index > 0) {
+            int parent = (index - 1) / Arity;
+            if (!(entry.priority < heap[parent].priority)) break;
+            place(index, heap[parent]);
+            index = parent;
+        }
+        place(index, entry);
+    }
+
+    void siftDown(int index) {
+        Entry entry = heap[index];
+        int count = static_cast<int>(heap.size());
+        while (true) {
+            int first = index * Arity + 1;
+            if (first >= count) break;
+            int last = std::min(first + Arity, count);
+            int best = first;
+            for (int child = first + 1; child < last; ++child) {
+                if (heap[child].priority < heap[best].priority) best = child;
+            }
+            if (!(heap[best].priority < entry.priority)) break;
+            place(index, heap[best]);
+            index = best;
+        }
+        place(index, entry);
+    }
+
+public:
+    void reset(int num_keys) {
+        if (num_keys > static_cast<int>(positions.size())) {
+            positions.allocate(num_keys);
+        }
+        heap.clear();
+    }
+
+    void clear() {
+        heap.clear();
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    int size() const {
+        return static_cast<int>(heap.size());
+    }
+
+    // Positions of absent keys are stale, so membership is confirmed
+    // against the entry they point at.
+    bool contains(int key) const {
+        int index = positions[key];
+        return index >= 0 && index < static_cast<int>(heap.size()) && heap[index].key == key;
+    }
+
+    int top() const {
+        return heap[0].key;
+    }
+
+    const Priority& topPriority() const {
+        return heap[0].priority;
+    }
+
+    const Priority& priority(int key) const {
+        return heap[positions[key]].priority;
+    }
+
+    // Key at heap slot index in [0, size()), for scans over the whole list
+    int keyAt(int index) const {
+        return heap[index].key;
+    }
+
+    void push(int key, const Priority& priority) {
+        Entry entry = {priority, key};
+        heap.push_back(entry);
+        siftUp(static_cast<int>(heap.size()) - 1);
+    }
+
+    void decrease(int key, const Priority& priority) {
+        int index = positions[key];
+        heap[index].priority = priority;
+        siftUp(index);
+    }
+
+    // Moves key in either direction
+    void update(int key, const Priority& priority) {
+        int index = positions[key];
+        bool up = priority < heap[index].priority;
+        heap[index].priority = priority;
+        if (up) siftUp(index);
+        else siftDown(index);
+    }
+
+    int pop() {
+        int key = heap[0].key;
+        remove(key);
+        return key;
+    }
+
+    void remove(int key) {
+        int index = positions[key];
+        Entry last = heap.back();
+        heap.pop_back();
+        if (index == static_cast<int>(heap.size())) return;
+        bool up = last.priority < heap[index].priority;
+        place(index, last);
+        if (up) siftUp(index);
+        else siftDown(index);
+    }
+};
+
+typedef IndexedHeap<double, 2> BinaryHeapOpenList;
+typedef IndexedHeap<double, 4> QuaternaryHeapOpenList;
+
+// Dial-style bucket queue over f-costs scaled to integers. With
+// SCALE = 1000 the move costs 1 and 1.414 are exact, so g-costs of octile
+// paths land on exact buckets; only the heuristic part is rounded.
+// Buckets form a circular window over [cursor, cursor + buckets.size())
+// that doubles when the spread of live priorities outgrows it. Keys within
+// a bucket are doubly linked through per-key arrays for O(1) decrease-key.
+class BucketOpenList {
+public:
+    static const int SCALE = 1000;
+
+    BucketOpenList() : count(0), cursor(0), max_priority(0) {}
+
+    void reset(int num_keys) {
+        if (num_keys > static_cast<int>(next.size())) {
+            next.allocate(num_keys);
+            prev.allocate(num_keys);
+            priorities.allocate(num_keys);
+        }
+        if (buckets.empty()) buckets.assign(1024, -1);
+        else if (count > 0) std::fill(buckets.begin(), buckets.end(), -1);
+        count = 0;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    int size() const {
+        return count;
+    }
+
+    void push(int key, double f_cost) {
+        int64_t priority = static_cast<int64_t>(std::floor(f_cost * SCALE + 0.5));
+        if (count == 0) {
+            cursor = max_priority = priority;
+        } else {
+            int64_t low = std::min(cursor, priority);
+            int64_t high = std::max(max_priority, priority);
+            if (high - low >= static_cast<int64_t>(buckets.size())) grow(high - low + 1);
+            cursor = low;
+            max_priority = high;
+        }
+        link(key, priority);
+        count++;
+    }
+
+    void decrease(int key, double f_cost) {
+        unlink(key);
+        count--;
+        push(key, f_cost);
+    }
+
+    int pop() {
+        int64_t mask = static_cast<int64_t>(buckets.size()) - 1;
+        while (buckets[cursor & mask] == -1) cursor++;
+        int key = buckets[cursor & mask];
+        unlink(key);
+        count--;
+        return key;
+    }
+
+private:
+    std::vector<int> buckets;
+    LazyArray<int> next;
+    LazyArray<int> prev;
+    LazyArray<int64_t> priorities;
+    int count;
+    int64_t cursor;
+    int64_t max_priority;
+
+    void link(int key, int64_t priority) {
+        int& head = buckets[priority & (static_cast<int64_t>(buckets.size()) - 1)];
+        priorities[key] = priority;
+        prev[key] = -1;
+        next[key] = head;
+        if (head != -1) prev[head] = key;
+        head = key;
+    }
+
+    void unlink(int key) {
+        if (prev[key] != -1) {
+            next[prev[key]] = next[key];
+        } else {
+            buckets[priorities[key] & (static_cast<int64_t>(buckets.size()) - 1)] = next[key];
+        }
+        if (next[key] != -1) prev[next[key]] = prev[key];
+    }
+
+    void grow(int64_t span) {
+        std::vector<int> keys;
+        keys.reserve(count);
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            for (int key = buckets[i]; key != -1; key = next[key]) keys.push_back(key);
+        }
+        size_t new_size = buckets.size();
+        while (static_cast<int64_t>(new_size) < span) new_size *= 2;
+        buckets.assign(new_size, -1);
+        for (size_t i = 0; i < keys.size(); ++i) link(keys[i], priorities[keys[i]]);
+    }
+};
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include "grid_generator.h"
+#include "heuristics.h"
+
+struct PathCacheCounters {
+    uint64_t hits;          // same endpoints cached
+    uint64_t sub_path_hits; // both endpoints on a cached path
+    uint64_t misses;        // went to the solver
+    uint64_t evictions;     // dropped to stay within capacity
+    uint64_t invalidated;   // dropped by invalidate() or a version change
+};
+
+// Bounded LRU cache of solver results in front of any grid solver (AStar,
+// JPS, ...), keyed by the endpoints and the map version. Every sub-path of
+// a shortest path is itself a shortest path, and moves cost the same both
+// ways, so a cached path also answers queries between any two of its cells
+// in either direction; the solver must return shortest paths (not HPA*).
+// Unreachable pairs are cached too.
+//
+// After editing the map, pass the changed cells to invalidate(): a newly
+// blocked cell drops only the paths through it, and a newly freed cell
+// drops only the paths with a stretch that a detour over it could shorten,
+// judged by the octile distance, plus the cached "no path" answers. This assumes a move
+// depends on its target cell alone (FourConnected, EightConnected). When
+// the whole map is replaced, setMapVersion() retires every older entry.
+template <class Solver, class MapT = Grid>
+class CachedPathfinder {
+private:
+    struct Entry {
+        uint64_t key;
+        uint64_t version;
+        bool found;
+        std::vector<Cell> path;
+        std::vector<double> prefix; // cost from path[0] to path[i]
+        int prev, next;             // LRU list, most recent first
+    };
+
+    struct Occurrence {
+        int slot;
+        int position;
+    };
+
+    Solver& solver;
+    const MapT& grid;
+    size_t capacity;
+    uint64_t version;
+
+    std::vector<Entry> slots;
+    std::vector<int> free_slots;
+    int head, tail;
+    size_t live;
+    std::unordered_map<uint64_t, int> by_endpoints;
+    std::unordered_map<int, std::vector<Occurrence> > by_cell;
+
+    std::vector<Cell> path;
+    double path_cost;
+    int nodes_expanded;
+    PathCacheCounters counters;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    uint64_t endpointsKey(const Cell& start, const Cell& goal) const {
+        return (static_cast<uint64_t>(cellToKey(start)) << 32) | static_cast<uint32_t>(cellToKey(goal));
+    }
+
+    void unlink(int slot) {
+        Entry& entry = slots[slot];
+        if (entry.prev != -1) slots[entry.prev].next = entry.next;
+        else head = entry.next;
+        if (entry.next != -1) slots[entry.next].prev = entry.prev;
+        else tail = entry.prev;
+    }
+
+    void linkFront(int slot) {
+        Entry& entry = slots[slot];
+        entry.prev = -1;
+        entry.next = head;
+        if (head != -1) slots[head].prev = slot;
+        head = slot;
+        if (tail == -1) tail = slot;
+    }
+
+    void touch(int slot) {
+        if (slot == head) return;
+        unlink(slot);
+        linkFront(slot);
+    }
+
+    void remove(int slot) {
+        Entry& entry = slots[slot];
+        unlink(slot);
+        by_endpoints.erase(entry.key);
+        for (size_t i = 0; i < entry.path.size(); ++i) {
+            typename std::unordered_map<int, std::vector<Occurrence> >::iterator found =
+                by_cell.find(cellToKey(entry.path[i]));
+            std::vector<Occurrence>& list = found->second;
+            for (size_t j = 0; j < list.size(); ++j) {
+                if (list[j].slot == slot) {
+                    list[j] = list.back();
+                    list.pop_back();
+                    break;
+                }
+            }
+            if (list.empty()) by_cell.erase(found);
+        }
+        entry.path.clear();
+        entry.prefix.clear();
+        free_slots.push_back(slot);
+        live--;
+    }
+
+    void insert(const Cell& start, const Cell& goal, bool found, const std::vector<Cell>& route) {
+        if (capacity == 0) return;
+        if (live == capacity) {
+            remove(tail);
+            counters.evictions++;
+        }
+        int slot;
+        if (free_slots.empty()) {
+            slot = static_cast<int>(slots.size());
+            slots.push_back(Entry());
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        }
+
+        Entry& entry = slots[slot];
+        entry.key = endpointsKey(start, goal);
+        entry.version = version;
+        entry.found = found;
+        entry.path = route;
+        entry.prefix.resize(route.size());
+        for (size_t i = 0; i < route.size(); ++i) {
+            bool diagonal = i > 0 && route[i].x != route[i - 1].x && route[i].y != route[i - 1].y;
+            entry.prefix[i] = i == 0 ? 0 : entry.prefix[i - 1] + (diagonal ? 1.414 : 1.0);
+            Occurrence occurrence = {slot, static_cast<int>(i)};
+            by_cell[cellToKey(route[i])].push_back(occurrence);
+        }
+        by_endpoints[entry.key] = slot;
+        linkFront(slot);
+        live++;
+    }
+
+    // Entries from before a setMapVersion() are dropped when met
+    bool current(int slot) {
+        if (slots[slot].version == version) return true;
+        remove(slot);
+        counters.invalidated++;
+        return false;
+    }
+
+    bool lookupExact(const Cell& start, const Cell& goal) {
+        std::unordered_map<uint64_t, int>::iterator found = by_endpoints.find(endpointsKey(start, goal));
+        if (found == by_endpoints.end()) return false;
+        int slot = found->second;
+        if (!current(slot)) return false;
+        const Entry& entry = slots[slot];
+        path = entry.path;
+        path_cost = entry.found ? entry.prefix.back() : 0;
+        touch(slot);
+        return true;
+    }
+
+    bool lookupSubPath(const Cell& start, const Cell& goal) {
+        // Solvers accept a blocked start, so a cached path may begin on an
+        // obstacle; leave such endpoints to the solver
+        if (grid.isObstacle(start.x, start.y) || grid.isObstacle(goal.x, goal.y)) return false;
+        typename std::unordered_map<int, std::vector<Occurrence> >::iterator from = by_cell.find(cellToKey(start));
+        typename std::unordered_map<int, std::vector<Occurrence> >::iterator to = by_cell.find(cellToKey(goal));
+        if (from == by_cell.end() || to == by_cell.end()) return false;
+        for (size_t i = 0; i < from->second.size(); ++i) {
+            const Occurrence& first = from->second[i];
+            for (size_t j = 0; j < to->second.size(); ++j) {
+                const Occurrence& second = to->second[j];
+                if (second.slot != first.slot || slots[first.slot].version != version) continue;
+                const Entry& entry = slots[first.slot];
+                int lo = std::min(first.position, second.position), hi = std::max(first.position, second.position);
+                path.assign(entry.path.begin() + lo, entry.path.begin() + hi + 1);
+                if (first.position > second.position) std::reverse(path.begin(), path.end());
+                path_cost = entry.prefix[hi] - entry.prefix[lo];
+                touch(first.slot);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Whether a detour over `via` could beat some stretch path[i..j] of
+    // the entry: octile(path[i], via) + octile(via, path[j]) below its
+    // cost. Sub-path answers rely on every stretch, not just the whole path.
+    bool shortcut(const Entry& entry, const Cell& via) const {
+        double best_head = octileDistance(entry.path[0], via);
+        for (size_t j = 1; j < entry.path.size(); ++j) {
+            if (best_head + octileDistance(via, entry.path[j]) - entry.prefix[j] < -1e-9) return true;
+            best_head = std::min(best_head, octileDistance(entry.path[j], via) + entry.prefix[j]);
+        }
+        return false;
+    }
+
+public:
+    CachedPathfinder(Solver& s, const MapT& g, size_t capacity = 4096)
+        : solver(s), grid(g), capacity(capacity), version(0), head(-1), tail(-1), live(0), path_cost(0),
+          nodes_expanded(0), counters() {}
+
+    bool findPath() {
+        return findPath(grid.start, grid.goal);
+    }
+
+    bool findPath(const Cell& start, const Cell& goal) {
+        nodes_expanded = 0;
+        if (lookupExact(start, goal)) {
+            counters.hits++;
+            return !path.empty();
+        }
+        if (lookupSubPath(start, goal)) {
+            counters.sub_path_hits++;
+            return true;
+        }
+        counters.misses++;
+        bool found = solver.findPath(start, goal);
+        nodes_expanded = solver.getNodesExpanded();
+        path = solver.getPath();
+        path_cost = found ? solver.getPathCost() : 0;
+        if (!found) path.clear();
+        insert(start, goal, found, path);
+        return found;
+    }
+
+    // Drops the entries the obstacle changes at `changed` can affect; the
+    // grid must already hold the new state. Surviving entries keep their
+    // version, so only freed cells cost a pass over the cache.
+    void invalidate(const std::vector<Cell>& changed) {
+        std::vector<Cell> freed;
+        for (size_t i = 0; i < changed.size(); ++i) {
+            const Cell& cell = changed[i];
+            if (!grid.isObstacle(cell.x, cell.y)) {
+                freed.push_back(cell);
+                continue;
+            }
+            typename std::unordered_map<int, std::vector<Occurrence> >::iterator found = by_cell.find(cellToKey(cell));
+            while (found != by_cell.end()) {
+                remove(found->second.back().slot); // also erases the list once empty
+                counters.invalidated++;
+                found = by_cell.find(cellToKey(cell));
+            }
+        }
+
+        if (freed.empty()) return;
+        for (int slot = head; slot != -1;) {
+            Entry& entry = slots[slot];
+            int next = entry.next;
+            bool stale = !entry.found;
+            for (size_t i = 0; i < freed.size() && !stale; ++i) {
+                stale = shortcut(entry, freed[i]);
+            }
+            if (stale) {
+                remove(slot);
+                counters.invalidated++;
+            }
+            slot = next;
+        }
+    }
+
+    // For maps replaced wholesale: entries of other versions stop matching
+    void setMapVersion(uint64_t map_version) {
+        version = map_version;
+    }
+
+    uint64_t getMapVersion() const {
+        return version;
+    }
+
+    void clear() {
+        while (head != -1) remove(head);
+    }
+
+    size_t size() const {
+        return live;
+    }
+
+    const PathCacheCounters& getCounters() const {
+        return counters;
+    }
+
+    void resetCounters() {
+        counters = PathCacheCounters();
+    }
+
+    int getPathLength() const {
+        return path.size();
+    }
+
+    double getPathCost() const {
+        return path_cost;
+    }
+
+    // Zero when the answer came from the cache
+    int getNodesExpanded() const {
+        return nodes_expanded;
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+};
+
+#endif
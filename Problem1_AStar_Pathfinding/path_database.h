@@ -0,0 +1,377 @@
+#ifndef PATH_DATABASE_H
+#define PATH_DATABASE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include "grid_generator.h"
+#include "thread_pool.h"
+#include "mapped_file.h"
+
+// Compressed path database: the optimal first move from every free cell
+// towards every other cell, so a path is read off one move at a time with
+// no search at all. Moves and costs match AStar (8-connected, 1 and 1.414).
+//
+// The build runs one Dijkstra per source cell, rows of sources spread over
+// the thread pool. Costs are integer thousandths, which makes both move
+// costs exact, and each search is Dial's algorithm with one-unit buckets.
+// The row of first moves of one source is run-length encoded: a run is the
+// rank of the first target it covers and its move. Targets are ranked in
+// Z-order rather than row by row, which keeps nearby targets (which mostly
+// share a first move) together and needs two to three times fewer runs.
+// Where several first moves are optimal, the one that extends the current
+// run is taken, and obstacles, unreachable targets and the source itself
+// never get looked up, so they join whichever run they fall in. A lookup
+// is a binary search over the source's runs. Connected components are
+// stored too, so unreachable queries are answered without the runs.
+//
+// The table belongs to the grid it was built for and must be rebuilt after
+// obstacles change. Maps up to 2^29 cells.
+class PathDatabase {
+public:
+    static const int NO_MOVE = 8;
+
+private:
+    static const uint32_t UNIT = 1000;
+    static const uint32_t UNREACHABLE = 0xFFFFFFFF;
+    static const uint32_t NO_COMPONENT = 0xFFFFFFFF;
+    static const int DX[8];
+    static const int DY[8];
+    static const uint32_t STEP[8];
+
+    // File layout: this header, num_cells + 1 run offsets, num_cells
+    // component ids, num_cells target ranks, then the runs
+    struct FileHeader {
+        char magic[8];
+        uint32_t width;
+        uint32_t height;
+        uint64_t run_count;
+    };
+
+    struct Entry {
+        int key;
+        uint32_t cost;
+    };
+
+    // Per-worker Dijkstra state, reused for every source
+    struct Scratch {
+        std::vector<uint32_t> costs;
+        std::vector<uint8_t> moves; // bit d set when move d starts an optimal path
+        std::vector<Entry> ring[3];
+    };
+
+    int width;
+    int height;
+    std::vector<uint64_t> owned_offsets;
+    std::vector<uint32_t> owned_components;
+    std::vector<uint32_t> owned_ranks;
+    std::vector<uint32_t> owned_runs;
+    MappedFile mapped;
+    const uint64_t* offsets;     // runs of source s are [offsets[s], offsets[s + 1])
+    const uint32_t* components;  // NO_COMPONENT on obstacles
+    const uint32_t* ranks;       // Z-order rank of each cell as a target
+    const uint32_t* runs;        // first target rank << 3 | move
+
+    std::vector<Cell> path;
+    double path_cost;
+
+    static const char* magic() {
+        return "FMCPD02";
+    }
+
+    static void labelComponents(const Grid& grid, std::vector<uint32_t>& labels) {
+        int num_cells = grid.width * grid.height;
+        labels.assign(num_cells, NO_COMPONENT);
+        std::vector<int> stack;
+        uint32_t next_label = 0;
+        for (int key = 0; key < num_cells; ++key) {
+            if (labels[key] != NO_COMPONENT || grid.isObstacle(key % grid.width, key / grid.width)) continue;
+            labels[key] = next_label;
+            stack.push_back(key);
+            while (!stack.empty()) {
+                int current = stack.back();
+                stack.pop_back();
+                int x = current % grid.width, y = current / grid.width;
+                for (int d = 0; d < 8; ++d) {
+                    int nx = x + DX[d], ny = y + DY[d];
+                    if (grid.isObstacle(nx, ny)) continue;
+                    int next = ny * grid.width + nx;
+                    if (labels[next] != NO_COMPONENT) continue;
+                    labels[next] = next_label;
+                    stack.push_back(next);
+                }
+            }
+            next_label++;
+        }
+    }
+
+    // Every optimal first move from source to each cell, as a bit set.
+    // A cell takes the moves of each neighbor it can be reached through
+    // at its final cost. No cell can improve another of its own bucket, so
+    // every entry popped with its current cost is final, and so is its
+    // move set, since all neighbors reaching it lie in earlier buckets.
+    static void firstMoves(const Grid& grid, int source, Scratch& scratch) {
+        int num_cells = grid.width * grid.height;
+        scratch.costs.assign(num_cells, UNREACHABLE);
+        scratch.moves.assign(num_cells, 0);
+        scratch.costs[source] = 0;
+        Entry seed = {source, 0};
+        scratch.ring[0].push_back(seed);
+        size_t pending = 1;
+        for (uint32_t bucket = 0; pending > 0; ++bucket) {
+            std::vector<Entry>& current = scratch.ring[bucket % 3];
+            for (size_t i = 0; i < current.size(); ++i) {
+                Entry entry = current[i];
+                if (scratch.costs[entry.key] != entry.cost) continue;
+                int x = entry.key % grid.width, y = entry.key / grid.width;
+                for (int d = 0; d < 8; ++d) {
+                    int nx = x + DX[d], ny = y + DY[d];
+                    if (grid.isObstacle(nx, ny)) continue;
+                    int next = ny * grid.width + nx;
+                    uint32_t cost = entry.cost + STEP[d];
+                    uint8_t moves = entry.key == source ? 1 << d : scratch.moves[entry.key];
+                    if (cost == scratch.costs[next]) scratch.moves[next] |= moves;
+                    if (cost >= scratch.costs[next]) continue;
+                    scratch.costs[next] = cost;
+                    scratch.moves[next] = moves;
+                    Entry reached = {next, cost};
+                    scratch.ring[(cost / UNIT) % 3].push_back(reached);
+                    pending++;
+                }
+            }
+            pending -= current.size();
+            current.clear();
+        }
+    }
+
+    // Appends the runs of one source's row, targets listed by rank. A run
+    // grows while some move is optimal for all its targets, so ties are
+    // resolved in favour of longer runs; targets that are never looked up
+    // extend the current run. The first run starts at rank 0, so every
+    // lookup lands in one.
+    static void encodeRow(const Scratch& scratch, int source, const std::vector<uint32_t>& labels,
+                          const std::vector<int>& targets, std::vector<uint32_t>& out) {
+        uint32_t component = labels[source];
+        uint32_t run_start = 0;
+        uint8_t run_moves = 0xFF;
+        for (uint32_t rank = 0; rank < targets.size(); ++rank) {
+            int target = targets[rank];
+            if (target == source || labels[target] != component) continue;
+            uint8_t moves = scratch.moves[target];
+            if (run_moves & moves) {
+                run_moves &= moves;
+                continue;
+            }
+            out.push_back(run_start << 3 | lowestMove(run_moves));
+            run_start = rank;
+            run_moves = moves;
+        }
+        if (run_moves != 0xFF) out.push_back(run_start << 3 | lowestMove(run_moves));
+    }
+
+    // Interleaved bits of x and y
+    static uint64_t zOrder(uint32_t x, uint32_t y) {
+        uint64_t code = 0;
+        for (int bit = 0; bit < 32; ++bit) {
+            code |= (uint64_t(x >> bit & 1) << (2 * bit)) | (uint64_t(y >> bit & 1) << (2 * bit + 1));
+        }
+        return code;
+    }
+
+    static int lowestMove(uint8_t moves) {
+        int move = 0;
+        while (!(moves >> move & 1)) move++;
+        return move;
+    }
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * width + cell.x;
+    }
+
+    bool contains(const Cell& cell) const {
+        return cell.x >= 0 && cell.x < width && cell.y >= 0 && cell.y < height;
+    }
+
+public:
+    PathDatabase()
+        : width(0), height(0), offsets(nullptr), components(nullptr), ranks(nullptr), runs(nullptr),
+          path_cost(0) {}
+
+    // num_threads <= 0 uses every hardware thread
+    void build(const Grid& grid, int num_threads = 0) {
+        mapped.close();
+        width = grid.width;
+        height = grid.height;
+        int num_cells = width * height;
+        labelComponents(grid, owned_components);
+        std::vector<int> targets(num_cells);
+        for (int key = 0; key < num_cells; ++key) targets[key] = key;
+        std::sort(targets.begin(), targets.end(),
+                  [&](int a, int b) { return zOrder(a % width, a / width) < zOrder(b % width, b / width); });
+        owned_ranks.resize(num_cells);
+        for (int rank = 0; rank < num_cells; ++rank) owned_ranks[targets[rank]] = rank;
+
+        ThreadPool pool(num_threads);
+        std::vector<Scratch> scratch(pool.size());
+        std::vector<std::vector<uint32_t> > row_runs(height);
+        std::vector<std::vector<uint32_t> > row_counts(height);
+        std::atomic<int> next_row(0);
+        pool.run([&](int worker) {
+            for (int y = next_row++; y < height; y = next_row++) {
+                for (int x = 0; x < width; ++x) {
+                    int source = y * width + x;
+                    size_t before = row_runs[y].size();
+                    if (owned_components[source] != NO_COMPONENT) {
+                        firstMoves(grid, source, scratch[worker]);
+                        encodeRow(scratch[worker], source, owned_components, targets, row_runs[y]);
+                    }
+                    row_counts[y].push_back(static_cast<uint32_t>(row_runs[y].size() - before));
+                }
+            }
+        });
+
+        owned_offsets.assign(num_cells + 1, 0);
+        owned_runs.clear();
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int source = y * width + x;
+                owned_offsets[source + 1] = owned_offsets[source] + row_counts[y][x];
+            }
+            owned_runs.insert(owned_runs.end(), row_runs[y].begin(), row_runs[y].end());
+            std::vector<uint32_t>().swap(row_runs[y]);
+        }
+        offsets = owned_offsets.data();
+        components = owned_components.data();
+        ranks = owned_ranks.data();
+        runs = owned_runs.data();
+    }
+
+    bool save(const std::string& path_name) const {
+        std::ofstream out(path_name.c_str(), std::ios::binary);
+        if (!out) return false;
+        size_t num_cells = static_cast<size_t>(width) * height;
+        FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, magic(), sizeof(header.magic));
+        header.width = width;
+        header.height = height;
+        header.run_count = offsets[num_cells];
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(offsets), (num_cells + 1) * sizeof(uint64_t));
+        out.write(reinterpret_cast<const char*>(components), num_cells * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(ranks), num_cells * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(runs), header.run_count * sizeof(uint32_t));
+        return static_cast<bool>(out);
+    }
+
+    // Maps a database written by save() and reads it in place. Fails if
+    // the file is malformed or was built for a grid of another size.
+    bool load(const std::string& path_name, const Grid& grid) {
+        MappedFile file;
+        if (!file.open(path_name) || file.size() < sizeof(FileHeader)) return false;
+        FileHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, magic(), sizeof(header.magic)) != 0) return false;
+        if (header.width != static_cast<uint32_t>(grid.width) || header.height != static_cast<uint32_t>(grid.height)) {
+            return false;
+        }
+        size_t num_cells = static_cast<size_t>(header.width) * header.height;
+        size_t offsets_at = sizeof(FileHeader);
+        size_t components_at = offsets_at + (num_cells + 1) * sizeof(uint64_t);
+        size_t ranks_at = components_at + num_cells * sizeof(uint32_t);
+        size_t runs_at = ranks_at + num_cells * sizeof(uint32_t);
+        if (file.size() != runs_at + header.run_count * sizeof(uint32_t)) return false;
+        const uint64_t* file_offsets = reinterpret_cast<const uint64_t*>(file.data() + offsets_at);
+        if (file_offsets[num_cells] != header.run_count) return false;
+
+        width = header.width;
+        height = header.height;
+        std::vector<uint64_t>().swap(owned_offsets);
+        std::vector<uint32_t>().swap(owned_components);
+        std::vector<uint32_t>().swap(owned_ranks);
+        std::vector<uint32_t>().swap(owned_runs);
+        mapped.swap(file);
+        offsets = file_offsets;
+        components = reinterpret_cast<const uint32_t*>(mapped.data() + components_at);
+        ranks = reinterpret_cast<const uint32_t*>(mapped.data() + ranks_at);
+        runs = reinterpret_cast<const uint32_t*>(mapped.data() + runs_at);
+        return true;
+    }
+
+    bool isReachable(const Cell& from, const Cell& to) const {
+        uint32_t component = components[cellToKey(from)];
+        return component != NO_COMPONENT && component == components[cellToKey(to)];
+    }
+
+    // Index into the move table, NO_MOVE when from == to or unreachable
+    int firstMove(const Cell& from, const Cell& to) const {
+        if (from == to || !isReachable(from, to)) return NO_MOVE;
+        int source = cellToKey(from);
+        uint32_t rank = ranks[cellToKey(to)];
+        const uint32_t* begin = runs + offsets[source];
+        const uint32_t* end = runs + offsets[source + 1];
+        // Last run starting at or before the target
+        const uint32_t* run = std::upper_bound(begin, end, rank << 3 | 7) - 1;
+        return *run & 7;
+    }
+
+    // Follows first moves from start to goal; false if unreachable
+    bool findPath(const Cell& start, const Cell& goal) {
+        path.clear();
+        path_cost = 0;
+        if (!contains(start) || !contains(goal) || !isReachable(start, goal)) return false;
+        Cell cell = start;
+        path.push_back(cell);
+        while (!(cell == goal)) {
+            int move = firstMove(cell, goal);
+            cell.x += DX[move];
+            cell.y += DY[move];
+            path_cost += move < 4 ? 1.0 : 1.414;
+            path.push_back(cell);
+        }
+        return true;
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+
+    double getPathCost() const {
+        return path_cost;
+    }
+
+    int getPathLength() const {
+        return static_cast<int>(path.size());
+    }
+
+    // No search, so nothing is expanded
+    int getNodesExpanded() const {
+        return 0;
+    }
+
+    size_t runCount() const {
+        return offsets ? offsets[static_cast<size_t>(width) * height] : 0;
+    }
+
+    size_t memoryBytes() const {
+        size_t num_cells = static_cast<size_t>(width) * height;
+        return offsets ? (num_cells + 1) * sizeof(uint64_t) + 2 * num_cells * sizeof(uint32_t) +
+                             runCount() * sizeof(uint32_t)
+                       : 0;
+    }
+};
+
+// Straight moves first, as in EightConnected
+const int PathDatabase::DX[8] = {-1, 1, 0, 0, -1, -1, 1, 1};
+const int PathDatabase::DY[8] = {0, 0, -1, 1, -1, 1, -1, 1};
+const uint32_t PathDatabase::STEP[8] = {1000, 1000, 1000, 1000, 1414, 1414, 1414, 1414};
+const int PathDatabase::NO_MOVE;
+const uint32_t PathDatabase::UNIT;
+const uint32_t PathDatabase::UNREACHABLE;
+const uint32_t PathDatabase::NO_COMPONENT;
+
+#endif
@@ -0,0 +1,501 @@
+#ifndef PATH_SERVER_H
+#define PATH_SERVER_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "batch_pathfinder.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+// Wire format, in native byte order since both ends share the machine.
+// A client sends PathRequest frames and may pipeline any number of them;
+// each is answered on the same connection by a PathResponse header and
+// `moves` one-byte move codes from the start to the goal, or moves == -1
+// when there is no path or a cell is off the map or blocked.
+struct PathRequest {
+    uint32_t id;
+    int32_t start_x, start_y;
+    int32_t goal_x, goal_y;
+};
+
+struct PathResponse {
+    uint32_t id;
+    int32_t moves;
+    double cost;
+};
+
+// Move codes on the wire, the order of EightConnected
+const int PATH_MOVE_DX[8] = {-1, 1, 0, 0, -1, -1, 1, 1};
+const int PATH_MOVE_DY[8] = {0, 0, -1, 1, -1, 1, -1, 1};
+
+inline uint8_t pathMoveCode(const Cell& from, const Cell& to) {
+    static const uint8_t codes[9] = {4, 0, 5, 2, 0, 3, 6, 1, 7}; // by (dx + 1) * 3 + dy + 1
+    return codes[(to.x - from.x + 1) * 3 + (to.y - from.y + 1)];
+}
+
+// Long-running pathfinding service on a Unix domain socket. One thread
+// owns the map and runs the event loop: it waits on epoll, reads every
+// complete request from every ready connection, and hands them all to a
+// BatchPathfinder as one batch, whose workers keep their warm search
+// scratch between batches. Requests arriving while a batch is solved form
+// the next one, so batches grow with the load by themselves. Replies are
+// written without blocking; what the socket does not take is sent when
+// epoll reports it writable again.
+//
+// Linux only: elsewhere listen() fails.
+class PathServer {
+private:
+#ifdef __linux__
+    static const int MAX_EVENTS = 256;
+    static const size_t READ_CHUNK = 64 * 1024;
+
+    struct Connection {
+        int fd;
+        std::vector<char> input;
+        std::vector<char> output;
+        size_t output_sent;
+        uint32_t watched;  // epoll events registered for fd
+        bool read_closed;  // the client has sent everything it will
+        bool broken;       // a read or write failed; nothing more can be sent
+
+        // Closed once broken, or once the client is done and has every reply
+        bool finished() const {
+            return broken || (read_closed && output_sent == output.size());
+        }
+    };
+
+    // One request of the current batch; query is -1 when it is answered
+    // without a search
+    struct Pending {
+        Connection* connection;
+        uint32_t id;
+        int query;
+    };
+
+    const Grid& grid;
+    BatchPathfinder<> solver;
+    std::string socket_path;
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;
+    std::vector<Connection*> connections;
+    std::vector<PathQuery> queries;
+    std::vector<Pending> pending;
+    PathBatchResult results;
+    std::vector<char> read_buffer;
+    std::atomic<bool> stopping;
+    std::atomic<long long> answered;
+    std::atomic<long long> batches;
+
+    static bool makeNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    bool validCell(int32_t x, int32_t y) const {
+        return grid.isValidCell(x, y) && !grid.isObstacle(x, y);
+    }
+
+    void accept() {
+        while (true) {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) return;
+            if (!makeNonBlocking(fd)) {
+                ::close(fd);
+                continue;
+            }
+            Connection* connection = new Connection();
+            connection->fd = fd;
+            connection->output_sent = 0;
+            connection->watched = EPOLLIN;
+            connection->read_closed = false;
+            connection->broken = false;
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = connection;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+                ::close(fd);
+                delete connection;
+                continue;
+            }
+            connections.push_back(connection);
+        }
+    }
+
+    // Reads what the socket has and queues every complete request
+    void receive(Connection& connection) {
+        while (true) {
+            ssize_t count = ::read(connection.fd, read_buffer.data(), read_buffer.size());
+            if (count > 0) {
+                connection.input.insert(connection.input.end(), read_buffer.begin(), read_buffer.begin() + count);
+                continue;
+            }
+            if (count < 0 && errno == EINTR) continue;
+            // At end of input the requests already read are still answered
+            if (count == 0) connection.read_closed = true;
+            if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK) connection.broken = true;
+            break;
+        }
+
+        size_t offset = 0;
+        for (; offset + sizeof(PathRequest) <= connection.input.size(); offset += sizeof(PathRequest)) {
+            PathRequest request;
+            std::memcpy(&request, connection.input.data() + offset, sizeof(request));
+            Pending entry = {&connection, request.id, -1};
+            if (validCell(request.start_x, request.start_y) && validCell(request.goal_x, request.goal_y)) {
+                PathQuery query = {{request.start_x, request.start_y}, {request.goal_x, request.goal_y}};
+                entry.query = static_cast<int>(queries.size());
+                queries.push_back(query);
+            }
+            pending.push_back(entry);
+        }
+        connection.input.erase(connection.input.begin(), connection.input.begin() + offset);
+    }
+
+    // Sends as much queued output as the socket takes. Watches for
+    // writability only while some is left, and for input only until the
+    // client has finished sending.
+    void flush(Connection& connection) {
+        while (connection.output_sent < connection.output.size() && !connection.broken) {
+            ssize_t count = ::send(connection.fd, connection.output.data() + connection.output_sent,
+                                   connection.output.size() - connection.output_sent, MSG_NOSIGNAL);
+            if (count > 0) {
+                connection.output_sent += count;
+            } else if (count < 0 && errno == EINTR) {
+                continue;
+            } else {
+                if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK) connection.broken = true;
+                break;
+            }
+        }
+        bool left = connection.output_sent < connection.output.size();
+        if (!left) {
+            connection.output.clear();
+            connection.output_sent = 0;
+        }
+        uint32_t wanted = (connection.read_closed ? 0 : static_cast<uint32_t>(EPOLLIN)) |
+                          (left ? static_cast<uint32_t>(EPOLLOUT) : 0);
+        if (wanted != connection.watched && !connection.finished()) {
+            epoll_event event;
+            event.events = wanted;
+            event.data.ptr = &connection;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection.fd, &event);
+            connection.watched = wanted;
+        }
+    }
+
+    void answerBatch() {
+        if (!queries.empty()) solver.solve(queries, results);
+        batches++;
+        answered += pending.size();
+        for (size_t i = 0; i < pending.size(); ++i) {
+            Connection& connection = *pending[i].connection;
+            PathResponse response = {pending[i].id, -1, 0};
+            int query = pending[i].query;
+            size_t length = query >= 0 && results.found[query] ? results.pathLength(query) : 0;
+            if (length > 0) {
+                response.moves = static_cast<int32_t>(length - 1);
+                response.cost = results.costs[query];
+            }
+            const char* header = reinterpret_cast<const char*>(&response);
+            connection.output.insert(connection.output.end(), header, header + sizeof(response));
+            const Cell* path = length > 0 ? results.pathBegin(query) : nullptr;
+            for (size_t step = 1; step < length; ++step) {
+                connection.output.push_back(static_cast<char>(pathMoveCode(path[step - 1], path[step])));
+            }
+        }
+        for (size_t i = 0; i < pending.size(); ++i) {
+            Connection& connection = *pending[i].connection;
+            if (i + 1 == pending.size() || pending[i + 1].connection != &connection) flush(connection);
+        }
+        queries.clear();
+        pending.clear();
+    }
+
+    void closeFinished() {
+        size_t kept = 0;
+        for (size_t i = 0; i < connections.size(); ++i) {
+            Connection* connection = connections[i];
+            if (!connection->finished()) {
+                connections[kept++] = connection;
+                continue;
+            }
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, connection->fd, nullptr);
+            ::close(connection->fd);
+            delete connection;
+        }
+        connections.resize(kept);
+    }
+#endif
+
+    PathServer(const PathServer&);
+    PathServer& operator=(const PathServer&);
+
+public:
+#ifdef __linux__
+    // num_threads <= 0 uses every hardware thread
+    PathServer(const Grid& g, int num_threads = 0)
+        : grid(g), solver(g, octileDistance, num_threads), listen_fd(-1), epoll_fd(-1), wake_fd(-1),
+          read_buffer(READ_CHUNK), stopping(false), answered(0), batches(0) {}
+#else
+    PathServer(const Grid&, int = 0) {}
+#endif
+
+    ~PathServer() {
+        close();
+    }
+
+    // Binds the socket, replacing a stale socket file at the path
+    bool listen(const std::string& path) {
+#ifdef __linux__
+        close();
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+        ::unlink(path.c_str());
+        listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        epoll_fd = epoll_create1(0);
+        wake_fd = eventfd(0, EFD_NONBLOCK);
+        if (listen_fd < 0 || epoll_fd < 0 || wake_fd < 0 || !makeNonBlocking(listen_fd) ||
+            ::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd, SOMAXCONN) != 0) {
+            close();
+            return false;
+        }
+        socket_path = path;
+        // The listener and the wake-up eventfd are told apart by pointer
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = &listen_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+        event.data.ptr = &wake_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+        stopping = false;
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    // Serves until stop() is called
+    void run() {
+#ifdef __linux__
+        epoll_event events[MAX_EVENTS];
+        while (!stopping) {
+            int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+            if (count < 0 && errno != EINTR) break;
+            for (int i = 0; i < count; ++i) {
+                void* source = events[i].data.ptr;
+                if (source == &listen_fd) {
+                    accept();
+                } else if (source == &wake_fd) {
+                    uint64_t value;
+                    ssize_t ignored = ::read(wake_fd, &value, sizeof(value));
+                    (void)ignored;
+                } else {
+                    Connection& connection = *static_cast<Connection*>(source);
+                    uint32_t ready = events[i].events;
+                    if ((ready & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !connection.read_closed) receive(connection);
+                    // After end of input, flushing also stops watching for it
+                    if ((ready & (EPOLLOUT | EPOLLHUP | EPOLLERR)) || connection.read_closed) flush(connection);
+                }
+            }
+            if (!pending.empty()) answerBatch();
+            closeFinished();
+        }
+#endif
+    }
+
+    // Makes run() return; callable from any thread
+    void stop() {
+#ifdef __linux__
+        stopping = true;
+        uint64_t one = 1;
+        if (wake_fd >= 0) {
+            ssize_t ignored = ::write(wake_fd, &one, sizeof(one));
+            (void)ignored;
+        }
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        for (size_t i = 0; i < connections.size(); ++i) connections[i]->broken = true;
+        if (epoll_fd >= 0) closeFinished();
+        if (listen_fd >= 0) ::close(listen_fd);
+        if (epoll_fd >= 0) ::close(epoll_fd);
+        if (wake_fd >= 0) ::close(wake_fd);
+        if (!socket_path.empty()) ::unlink(socket_path.c_str());
+        listen_fd = epoll_fd = wake_fd = -1;
+        socket_path.clear();
+#endif
+    }
+
+    int threadCount() const {
+#ifdef __linux__
+        return solver.threadCount();
+#else
+        return 0;
+#endif
+    }
+
+    long long getQueriesAnswered() const {
+#ifdef __linux__
+        return answered;
+#else
+        return 0;
+#endif
+    }
+
+    long long getBatches() const {
+#ifdef __linux__
+        return batches;
+#else
+        return 0;
+#endif
+    }
+};
+
+struct LoadReport {
+    long long queries;
+    long long unreachable; // answered with moves == -1
+    long long wrong;       // paths that do not end at the goal, or lost replies
+    double seconds;
+    double p50_us, p99_us, p999_us;
+};
+
+// Local load generator: `clients` threads, each on its own connection
+// with `depth` requests in flight, send `per_client` queries drawn from
+// `queries` in turn and time every reply. Paths are decoded and checked
+// to end at the goal. Fails if a client cannot connect.
+bool runPathLoad(const std::string& socket_path, const std::vector<PathQuery>& queries, int clients, int depth,
+                 int per_client, LoadReport& report) {
+#ifdef __linux__
+    typedef std::chrono::steady_clock Clock;
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (queries.empty() || socket_path.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+
+    std::vector<int> fds(clients, -1);
+    bool connected = true;
+    for (int c = 0; c < clients && connected; ++c) {
+        fds[c] = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        connected = fds[c] >= 0 && ::connect(fds[c], reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    }
+    if (!connected) {
+        for (int c = 0; c < clients; ++c) {
+            if (fds[c] >= 0) ::close(fds[c]);
+        }
+        return false;
+    }
+
+    std::vector<std::vector<double> > latencies(clients);
+    std::vector<long long> unreachable(clients, 0), wrong(clients, 0);
+    auto client = [&](int c) {
+        int fd = fds[c];
+        std::vector<Clock::time_point> sent_at(per_client);
+        std::vector<char> moves;
+        auto sendAll = [&](const void* data, size_t size) {
+            const char* bytes = static_cast<const char*>(data);
+            while (size > 0) {
+                ssize_t count = ::send(fd, bytes, size, MSG_NOSIGNAL);
+                if (count <= 0 && errno != EINTR) return false;
+                if (count > 0) bytes += count, size -= count;
+            }
+            return true;
+        };
+        auto receiveAll = [&](void* data, size_t size) {
+            char* bytes = static_cast<char*>(data);
+            while (size > 0) {
+                ssize_t count = ::recv(fd, bytes, size, 0);
+                if (count <= 0 && (count == 0 || errno != EINTR)) return false;
+                if (count > 0) bytes += count, size -= count;
+            }
+            return true;
+        };
+        auto queryOf = [&](int id) -> const PathQuery& {
+            return queries[(static_cast<size_t>(c) * per_client + id) % queries.size()];
+        };
+
+        int next = 0, done = 0;
+        while (done < per_client) {
+            // Top up the pipeline, then wait for one reply
+            while (next < per_client && next - done < depth) {
+                const PathQuery& query = queryOf(next);
+                PathRequest request = {static_cast<uint32_t>(next), query.start.x, query.start.y, query.goal.x,
+                                       query.goal.y};
+                sent_at[next] = Clock::now();
+                if (!sendAll(&request, sizeof(request))) break;
+                next++;
+            }
+            PathResponse response;
+            if (!receiveAll(&response, sizeof(response)) || response.id >= static_cast<uint32_t>(per_client)) break;
+            moves.resize(std::max(response.moves, 0));
+            if (!receiveAll(moves.data(), moves.size())) break;
+            latencies[c].push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent_at[response.id]).count());
+            done++;
+            if (response.moves < 0) {
+                unreachable[c]++;
+                continue;
+            }
+            const PathQuery& query = queryOf(response.id);
+            Cell cell = query.start;
+            for (size_t i = 0; i < moves.size(); ++i) {
+                int code = static_cast<uint8_t>(moves[i]) & 7;
+                cell.x += PATH_MOVE_DX[code];
+                cell.y += PATH_MOVE_DY[code];
+            }
+            if (!(cell == query.goal)) wrong[c]++;
+        }
+        wrong[c] += per_client - done;
+        ::close(fd);
+    };
+
+    auto begin = Clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c) threads.push_back(std::thread(client, c));
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+    report.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    std::vector<double> all;
+    report.unreachable = report.wrong = 0;
+    for (int c = 0; c < clients; ++c) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        report.unreachable += unreachable[c];
+        report.wrong += wrong[c];
+    }
+    report.queries = all.size();
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) { return all.empty() ? 0.0 : all[std::min(all.size() - 1, size_t(p * all.size()))]; };
+    report.p50_us = percentile(0.5);
+    report.p99_us = percentile(0.99);
+    report.p999_us = percentile(0.999);
+    return true;
+#else
+    (void)socket_path, (void)queries, (void)clients, (void)depth, (void)per_client, (void)report;
+    return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Cycles, retired instructions and last-level cache misses of the calling
+// thread, read through Linux perf_event_open as one counter group so the
+// three values cover exactly the same interval. open() fails when the
+// kernel refuses access (see /proc/sys/kernel/perf_event_paranoid) or on
+// other platforms; the caller then simply has no hardware numbers.
+class HardwareCounters {
+private:
+    int fds[3];
+
+#ifdef __linux__
+    static int openCounter(uint32_t type, uint64_t config, int group) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = group == -1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+
+    HardwareCounters(const HardwareCounters&);
+    HardwareCounters& operator=(const HardwareCounters&);
+
+public:
+    HardwareCounters() {
+        fds[0] = fds[1] = fds[2] = -1;
+    }
+
+    ~HardwareCounters() {
+        close();
+    }
+
+    bool open() {
+#ifdef __linux__
+        if (isOpen()) return true;
+        fds[0] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (fds[0] < 0) return false;
+        fds[1] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, fds[0]);
+        fds[2] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, fds[0]);
+        if (fds[1] < 0 || fds[2] < 0) {
+            close();
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        for (int i = 2; i >= 0; --i) {
+            if (fds[i] >= 0) ::close(fds[i]);
+            fds[i] = -1;
+        }
+#endif
+    }
+
+    bool isOpen() const {
+        return fds[0] >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Stops counting and reports the values since start()
+    bool stop(uint64_t& cycles, uint64_t& instructions, uint64_t& llc_misses) {
+#ifdef __linux__
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[4]; // count, then one value per counter
+        if (read(fds[0], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[0] != 3) {
+            return false;
+        }
+        cycles = values[1];
+        instructions = values[2];
+        llc_misses = values[3];
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+#endif
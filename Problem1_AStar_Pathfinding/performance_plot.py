@@ -56,5 +56,32 @@ def plot_performance_comparison():
             print(f"  Avg Path Length: {success_data['PathLength'].mean():.2f}")
             print(f"  Avg Nodes Expanded: {success_data['NodesExpanded'].mean():.2f}")
 
+def plot_benchmark_results(path='benchmark_data.csv'):
+    # Read the output of `astar_solver bench`
+    df = pd.read_csv(path)
+    df['Configuration'] = df['Solver'] + '/' + df['Heuristic']
+
+    fig, axes = plt.subplots(2, 2, figsize=(15, 12))
+    for ax, metric in zip([axes[0,0], axes[0,1], axes[1,0]], ['P50Ns', 'P95Ns', 'P99Ns']):
+        sns.lineplot(data=df, x='Width', y=metric, hue='Configuration', marker='o', ax=ax)
+        ax.set_xscale('log', base=2)
+        ax.set_yscale('log')
+        ax.set_title(f'{metric[:3]} latency (ns)')
+        ax.set_xlabel('Grid size')
+
+    sns.lineplot(data=df, x='Width', y='QueriesPerSec', hue='Configuration', marker='o', ax=axes[1,1])
+    axes[1,1].set_xscale('log', base=2)
+    axes[1,1].set_yscale('log')
+    axes[1,1].set_title('Throughput (queries/s)')
+    axes[1,1].set_xlabel('Grid size')
+
+    plt.tight_layout()
+    plt.savefig('benchmark_comparison.png', dpi=300, bbox_inches='tight')
+    plt.show()
+
+
 if __name__ == "__main__":
-    plot_performance_comparison()
\ No newline at end of file
+    import os
+    plot_performance_comparison()
+    if os.path.exists('benchmark_data.csv'):
+        plot_benchmark_results()
\ No newline at end of file
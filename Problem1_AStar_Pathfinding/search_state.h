@@ -0,0 +1,71 @@
+#ifndef SEARCH_STATE_H
+#define SEARCH_STATE_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "lazy_array.h"
+
+// Per-cell search bookkeeping held in flat arrays indexed by cell key
+// (y * width + x). An entry only counts when its stamp carries the current
+// generation, so starting a new query is O(1) and no memory is released
+// between queries. The arrays start as untouched zero pages, so cells a
+// search never reaches cost no physical memory.
+class SearchState {
+public:
+    enum Status { UNSEEN = 0, OPEN = 1, CLOSED = 2 };
+
+    SearchState() : generation(0) {}
+
+    void reset(int num_cells) {
+        if (num_cells != static_cast<int>(stamps.size())) {
+            g_costs.allocate(num_cells);
+            parents.allocate(num_cells);
+            stamps.allocate(num_cells);
+            generation = 0;
+        }
+        // The low two bits of a stamp hold the status, so the generation
+        // wraps after 2^30 queries and the stamps must be cleared once.
+        if (++generation >= (1u << 30)) {
+            stamps.clear();
+            generation = 1;
+        }
+    }
+
+    Status status(int key) const {
+        uint32_t stamp = stamps[key];
+        return (stamp >> 2) == generation ? static_cast<Status>(stamp & 3) : UNSEEN;
+    }
+
+    // Records a (better) cost for key and marks it open.
+    void open(int key, double g, int parent) {
+        g_costs[key] = g;
+        parents[key] = parent;
+        stamps[key] = (generation << 2) | OPEN;
+    }
+
+    void close(int key) {
+        stamps[key] = (generation << 2) | CLOSED;
+    }
+
+    double g(int key) const {
+        return g_costs[key];
+    }
+
+    // -1 for the start of the search
+    int parent(int key) const {
+        return parents[key];
+    }
+
+    int size() const {
+        return static_cast<int>(stamps.size());
+    }
+
+private:
+    LazyArray<double> g_costs;
+    LazyArray<int> parents;
+    LazyArray<uint32_t> stamps;
+    uint32_t generation;
+};
+
+#endif
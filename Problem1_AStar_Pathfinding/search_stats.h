@@ -0,0 +1,81 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include "perf_counters.h"
+
+// Opt-in instrumentation for the search loop. Define ASTAR_ENABLE_STATS
+// (e.g. -DASTAR_ENABLE_STATS) to count open-list operations and neighbor
+// handling, time the phases of each query and, on Linux, read hardware
+// counters. Without it ASTAR_STAT(...) expands to nothing and the solvers
+// carry no stats members, so the normal build is unchanged.
+#ifdef ASTAR_ENABLE_STATS
+#define ASTAR_STAT(statement) statement
+#else
+#define ASTAR_STAT(statement)
+#endif
+
+struct SearchStats {
+    uint64_t pushes;
+    uint64_t pops;
+    uint64_t decrease_keys;
+    uint64_t reopenings;          // closed cells pushed again with a better g
+    uint64_t neighbors_generated; // free neighbors produced by the neighborhood
+    uint64_t neighbors_rejected;  // of those, ones that did not improve g
+    uint64_t neighbors_blocked;   // candidate moves ruled out by obstacles
+    uint64_t peak_open;
+    uint64_t peak_closed;
+    uint64_t closed;
+
+    // Nanoseconds per phase; the timers themselves cost tens of
+    // nanoseconds per call, so compare phases rather than totals
+    uint64_t open_list_ns;
+    uint64_t neighbors_ns;
+    uint64_t total_ns;
+
+    // Valid only when hardware_counters is set
+    bool hardware_counters;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t llc_misses;
+
+    SearchStats() {
+        reset();
+    }
+
+    void reset() {
+        pushes = pops = decrease_keys = reopenings = 0;
+        neighbors_generated = neighbors_rejected = neighbors_blocked = 0;
+        peak_open = peak_closed = closed = 0;
+        open_list_ns = neighbors_ns = total_ns = 0;
+        hardware_counters = false;
+        cycles = instructions = llc_misses = 0;
+    }
+
+    void notePop() {
+        pops++;
+        closed++;
+        if (closed > peak_closed) peak_closed = closed;
+    }
+
+    void noteOpenSize(int size) {
+        if (static_cast<uint64_t>(size) > peak_open) peak_open = size;
+    }
+};
+
+// Adds the lifetime of the timer to a counter in nanoseconds
+class PhaseTimer {
+private:
+    uint64_t& total;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit PhaseTimer(uint64_t& counter) : total(counter), start(std::chrono::steady_clock::now()) {}
+
+    ~PhaseTimer() {
+        total += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+#endif
@@ -0,0 +1,464 @@
+#ifndef SMA_STAR_H
+#define SMA_STAR_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "grid_generator.h"
+#include "heuristics.h"
+#include "neighborhoods.h"
+
+// Memory-bounded A* (SMA*) for maps whose search would not fit in RAM.
+// All search memory is allocated once from a byte budget: a fixed pool of
+// nodes, an open-addressing index of the cells in it, and two heaps over
+// the pool. When the pool is full a node is dropped to make room: first a
+// closed node without children (every neighbour was held at least as
+// cheaply by another path when it was expanded, so it is forgotten
+// outright), otherwise the open leaf with the highest f. A dropped leaf's f
+// is backed up into its parent, which is reopened with that f and
+// regenerates the leaf once the search gets that far. Children are
+// generated best first, and one that would be the worst node in memory is
+// backed up straight away instead of displacing another. Nodes with
+// children are never dropped, so the path to every node stays in memory.
+//
+// The path returned is optimal for an admissible, consistent heuristic
+// (Octile for eight-connected moves). If the pool fills with a single path
+// findPath() fails and isOutOfMemory() says why. The tighter the budget,
+// the more nodes are expanded again (getNodesExpanded() counts every
+// expansion); far below what the search needs unbounded that can go on
+// for a very long time, which setExpansionLimit() cuts short.
+template <class HeuristicT = Heuristic, class Neighborhood = EightConnected, class MapT = Grid>
+class BasicMemoryBoundedAStar {
+private:
+    struct Node {
+        double g;
+        double f;         // key in the heaps; raised by backed-up children
+        double forgotten; // least f of the dropped children, infinity if none
+        int cell;
+        int parent;       // -1 for the start
+        int children;     // nodes in the pool whose parent this is
+        int slot[2];      // position in best / worst heap, -1 when absent
+        bool open;
+    };
+
+    struct IndexSlot {
+        int cell; // -1 when empty
+        int node;
+    };
+
+    enum { BEST = 0, WORST = 1 };
+
+    const MapT& grid;
+    HeuristicT heuristic;
+    size_t budget;
+    int capacity;
+
+    std::vector<Node> nodes;
+    std::vector<int> free_nodes;
+    std::vector<IndexSlot> index;
+    size_t index_mask;
+    std::vector<int> heaps[2]; // open nodes by best f; nodes without children by worst f
+    int expanding;             // the node whose children are being generated, never dropped
+
+    Cell goal;
+    std::vector<Cell> path;
+    double path_cost;
+    int nodes_expanded;
+    long long dropped;
+    int peak_nodes;
+    long long expansion_limit;
+    bool out_of_memory;
+
+    int cellToKey(const Cell& cell) const {
+        return cell.y * grid.width + cell.x;
+    }
+
+    Cell keyToCell(int key) const {
+        Cell cell = {key % grid.width, key / grid.width};
+        return cell;
+    }
+
+    size_t home(int cell) const {
+        return (static_cast<uint32_t>(cell) * 2654435761u) & index_mask;
+    }
+
+    int lookup(int cell) const {
+        for (size_t i = home(cell);; i = (i + 1) & index_mask) {
+            if (index[i].cell == cell) return index[i].node;
+            if (index[i].cell == -1) return -1;
+        }
+    }
+
+    void indexInsert(int cell, int node) {
+        size_t i = home(cell);
+        while (index[i].cell != -1) i = (i + 1) & index_mask;
+        index[i].cell = cell;
+        index[i].node = node;
+    }
+
+    // Linear probing with backward-shift deletion, so no tombstones pile up
+    void indexErase(int cell) {
+        size_t i = home(cell);
+        while (index[i].cell != cell) i = (i + 1) & index_mask;
+        for (size_t j = (i + 1) & index_mask; index[j].cell != -1; j = (j + 1) & index_mask) {
+            size_t wanted = home(index[j].cell);
+            // Move j into the hole unless its home lies cyclically in (i, j]
+            bool stays = i <= j ? (i < wanted && wanted <= j) : (i < wanted || wanted <= j);
+            if (!stays) {
+                index[i] = index[j];
+                i = j;
+            }
+        }
+        index[i].cell = -1;
+    }
+
+    bool before(int a, int b, int heap) const {
+        const Node& x = nodes[a];
+        const Node& y = nodes[b];
+        // Best: lowest f, then deepest; worst: the reverse
+        // (closed nodes in the worst heap have no children and go first)
+        if (heap == BEST) return x.f < y.f || (x.f == y.f && x.g > y.g);
+        if (x.open != y.open) return !x.open;
+        return x.f > y.f || (x.f == y.f && x.g < y.g);
+    }
+
+    void place(int heap, int position, int node) {
+        heaps[heap][position] = node;
+        nodes[node].slot[heap] = position;
+    }
+
+    void siftUp(int heap, int position) {
+        int node = heaps[heap][position];
+        while (position > 0) {
+            int parent = (position - 1) / 2;
+            if (!before(node, heaps[heap][parent], heap)) break;
+            place(heap, position, heaps[heap][parent]);
+            position = parent;
+        }
+        place(heap, position, node);
+    }
+
+    void siftDown(int heap, int position) {
+        std::vector<int>& items = heaps[heap];
+        int size = static_cast<int>(items.size());
+        int node = items[position];
+        while (true) {
+            int child = 2 * position + 1;
+            if (child >= size) break;
+            if (child + 1 < size && before(items[child + 1], items[child], heap)) child++;
+            if (!before(items[child], node, heap)) break;
+            place(heap, position, items[child]);
+            position = child;
+        }
+        place(heap, position, node);
+    }
+
+    void heapPush(int heap, int node) {
+        heaps[heap].push_back(node);
+        siftUp(heap, static_cast<int>(heaps[heap].size()) - 1);
+    }
+
+    void heapRemove(int heap, int node) {
+        int position = nodes[node].slot[heap];
+        if (position < 0) return;
+        nodes[node].slot[heap] = -1;
+        int last = heaps[heap].back();
+        heaps[heap].pop_back();
+        if (last == node) return;
+        place(heap, position, last);
+        siftUp(heap, position);
+        siftDown(heap, nodes[last].slot[heap]);
+    }
+
+    // Brings the heaps up to date after node's f, open flag or children
+    // changed
+    void reposition(int node) {
+        Node& n = nodes[node];
+        if (n.open && n.slot[BEST] < 0) heapPush(BEST, node);
+        if (!n.open) heapRemove(BEST, node);
+        bool leaf = n.children == 0 && node != expanding;
+        if (leaf && n.slot[WORST] < 0) heapPush(WORST, node);
+        if (!leaf) heapRemove(WORST, node);
+        for (int heap = BEST; heap <= WORST; ++heap) {
+            if (n.slot[heap] < 0) continue;
+            siftUp(heap, n.slot[heap]);
+            siftDown(heap, n.slot[heap]);
+        }
+    }
+
+    // Lower bound on paths through a new child of parent at cell
+    double childBound(int parent, int cell, double g) const {
+        double f = g + heuristic(keyToCell(cell), goal);
+        // Pathmax: a regenerated child keeps the f its parent backed up
+        return parent >= 0 ? std::max(f, nodes[parent].f) : f;
+    }
+
+    void release(int node) {
+        heapRemove(BEST, node);
+        heapRemove(WORST, node);
+        indexErase(nodes[node].cell);
+        nodes[node].cell = -1;
+        free_nodes.push_back(node);
+        dropped++;
+    }
+
+    void detach(int node) {
+        int parent = nodes[node].parent;
+        if (parent < 0) return;
+        nodes[parent].children--;
+        reposition(parent);
+    }
+
+    // Frees the first node of the worst heap, which must not be empty
+    void dropNode() {
+        int node = heaps[WORST][0];
+        int parent = nodes[node].parent;
+        if (!nodes[node].open) {
+            detach(node);
+            release(node);
+            return;
+        }
+        double bound = nodes[node].f;
+        release(node);
+        if (parent >= 0) {
+            Node& p = nodes[parent];
+            p.forgotten = std::min(p.forgotten, bound);
+            p.children--;
+            if (parent == expanding) {
+                // Its f still bounds the children it is generating; it is
+                // reopened once they are all out
+            } else if (!p.open) {
+                // Expand the parent again once the search reaches the child
+                p.open = true;
+                p.f = p.forgotten;
+            } else {
+                p.f = std::min(p.f, p.forgotten);
+            }
+            reposition(parent);
+        }
+    }
+
+    int newNode(int cell, int parent, double g) {
+        int node = free_nodes.back();
+        free_nodes.pop_back();
+        Node& n = nodes[node];
+        n.g = g;
+        n.f = childBound(parent, cell, g);
+        n.forgotten = std::numeric_limits<double>::infinity();
+        n.cell = cell;
+        n.parent = parent;
+        n.children = 0;
+        n.slot[BEST] = n.slot[WORST] = -1;
+        n.open = true;
+        indexInsert(cell, node);
+        reposition(node);
+        if (parent >= 0) {
+            nodes[parent].children++;
+            reposition(parent);
+        }
+        peak_nodes = std::max(peak_nodes, capacity - static_cast<int>(free_nodes.size()));
+        return node;
+    }
+
+    void reconstructPath(int node) {
+        path.clear();
+        path_cost = nodes[node].g;
+        for (; node != -1; node = nodes[node].parent) path.push_back(keyToCell(nodes[node].cell));
+        std::reverse(path.begin(), path.end());
+    }
+
+    void reset() {
+        free_nodes.clear();
+        for (int i = capacity - 1; i >= 0; --i) free_nodes.push_back(i);
+        std::fill(index.begin(), index.end(), IndexSlot{-1, -1});
+        heaps[BEST].clear();
+        heaps[WORST].clear();
+        expanding = -1;
+        path.clear();
+        path_cost = 0;
+        nodes_expanded = 0;
+        dropped = 0;
+        peak_nodes = 0;
+        out_of_memory = false;
+    }
+
+    bool search(const Cell& start, const Cell& target) {
+        goal = target;
+        reset();
+        if (capacity < 2) {
+            out_of_memory = true;
+            return false;
+        }
+        int goal_key = cellToKey(goal);
+        newNode(cellToKey(start), -1, 0);
+
+        Cell neighbors[Neighborhood::MAX_NEIGHBORS];
+        double costs[Neighborhood::MAX_NEIGHBORS];
+        double bounds[Neighborhood::MAX_NEIGHBORS];
+        int order[Neighborhood::MAX_NEIGHBORS];
+        while (!heaps[BEST].empty()) {
+            int current = heaps[BEST][0];
+            if (nodes[current].cell == goal_key) {
+                reconstructPath(current);
+                return true;
+            }
+            if (expansion_limit >= 0 && nodes_expanded >= expansion_limit) {
+                out_of_memory = true;
+                return false;
+            }
+            nodes_expanded++;
+            expanding = current;
+            nodes[current].open = false;
+            nodes[current].forgotten = std::numeric_limits<double>::infinity();
+            reposition(current);
+
+            double current_g = nodes[current].g;
+            int count = Neighborhood::expand(grid, keyToCell(nodes[current].cell), neighbors, costs);
+            for (int i = 0; i < count; ++i) {
+                bounds[i] = childBound(current, cellToKey(neighbors[i]), current_g + costs[i]);
+                int j = i;
+                for (; j > 0 && bounds[order[j - 1]] > bounds[i]; --j) order[j] = order[j - 1];
+                order[j] = i;
+            }
+            for (int k = 0; k < count; ++k) {
+                int i = order[k];
+                int cell = cellToKey(neighbors[i]);
+                double g = current_g + costs[i];
+                int existing = lookup(cell);
+                if (existing >= 0) {
+                    Node& n = nodes[existing];
+                    if (g >= n.g) continue;
+                    // Shorter way to a node in memory: hang it under current
+                    detach(existing);
+                    n.parent = current;
+                    nodes[current].children++;
+                    reposition(current);
+                    // Its old f may only bound the children it dropped; re-expanding
+                    // it passes the shorter path on to the ones it still has
+                    n.f = childBound(current, cell, g);
+                    n.g = g;
+                    n.open = true;
+                    reposition(existing);
+                    continue;
+                }
+                if (free_nodes.empty()) {
+                    if (heaps[WORST].empty()) {
+                        out_of_memory = true;
+                        return false;
+                    }
+                    const Node& worst = nodes[heaps[WORST][0]];
+                    if (worst.open && (worst.f < bounds[i] || (worst.f == bounds[i] && worst.g >= g))) {
+                        // It would be dropped first; remember it like a dropped child
+                        nodes[current].forgotten = std::min(nodes[current].forgotten, bounds[i]);
+                        continue;
+                    }
+                    dropNode();
+                }
+                newNode(cell, current, g);
+            }
+            expanding = -1;
+            Node& expanded = nodes[current];
+            if (expanded.forgotten != std::numeric_limits<double>::infinity()) {
+                expanded.open = true;
+                expanded.f = std::max(expanded.f, expanded.forgotten);
+            }
+            reposition(current);
+        }
+        return false; // No path found
+    }
+
+public:
+    // Pool, index and heap slots used per node
+    static size_t bytesPerNode() {
+        return sizeof(Node) + 2 * sizeof(IndexSlot) + 3 * sizeof(int);
+    }
+
+    // The pool holds about budget_bytes / bytesPerNode() nodes
+    BasicMemoryBoundedAStar(const MapT& g, size_t budget_bytes, HeuristicT h = HeuristicT())
+        : grid(g), heuristic(h), budget(budget_bytes), expanding(-1), path_cost(0), nodes_expanded(0), dropped(0),
+          peak_nodes(0), expansion_limit(-1), out_of_memory(false) {
+        size_t wanted = budget_bytes / bytesPerNode();
+        capacity = static_cast<int>(std::min<size_t>(wanted, std::numeric_limits<int>::max() / 2));
+        size_t index_size = 1;
+        while (index_size < 2 * static_cast<size_t>(capacity)) index_size <<= 1;
+        // A power-of-two index may be up to twice the minimum; shrink the
+        // pool until the whole layout fits the budget
+        while (capacity > 0 && capacity * (sizeof(Node) + 3 * sizeof(int)) + index_size * sizeof(IndexSlot) > budget_bytes) {
+            if (index_size / 2 >= 2 * static_cast<size_t>(capacity - 1) && index_size > 1) index_size /= 2;
+            else capacity--;
+        }
+        nodes.resize(capacity);
+        free_nodes.reserve(capacity);
+        index.resize(index_size);
+        index_mask = index_size - 1;
+        heaps[BEST].reserve(capacity);
+        heaps[WORST].reserve(capacity);
+    }
+
+    bool findPath() {
+        return findPath(grid.start, grid.goal);
+    }
+
+    bool findPath(const Cell& start, const Cell& goal) {
+        return search(start, goal);
+    }
+
+    // Past this many expansions (negative: no limit, the default)
+    // findPath() gives up and reports running out of memory
+    void setExpansionLimit(long long limit) {
+        expansion_limit = limit;
+    }
+
+    // The last failure was for lack of memory (or of expansions under the
+    // limit), not for lack of a path
+    bool isOutOfMemory() const {
+        return out_of_memory;
+    }
+
+    // Bytes of search memory allocated, never more than the budget
+    size_t getReservedBytes() const {
+        return nodes.size() * sizeof(Node) + index.size() * sizeof(IndexSlot) +
+               (free_nodes.capacity() + heaps[BEST].capacity() + heaps[WORST].capacity()) *
+                   sizeof(int);
+    }
+
+    // Bytes the most nodes held at once during the last query occupy
+    size_t getPeakBytes() const {
+        return static_cast<size_t>(peak_nodes) * bytesPerNode();
+    }
+
+    size_t getBudgetBytes() const {
+        return budget;
+    }
+
+    int getCapacity() const {
+        return capacity;
+    }
+
+    // Nodes dropped to stay within the budget during the last query
+    long long getNodesDropped() const {
+        return dropped;
+    }
+
+    int getPathLength() const {
+        return path.size();
+    }
+
+    double getPathCost() const {
+        return path_cost;
+    }
+
+    int getNodesExpanded() const {
+        return nodes_expanded;
+    }
+
+    const std::vector<Cell>& getPath() const {
+        return path;
+    }
+};
+
+typedef BasicMemoryBoundedAStar<> MemoryBoundedAStar;
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed set of worker threads that run one job at a time. The calling
+// thread takes part as worker 0, so a pool of size 1 starts no threads.
+// Jobs split their own work, typically by pulling indices from an atomic
+// counter, and run() returns once every worker has finished.
+class ThreadPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    const std::function<void(int)>* job;
+    unsigned long long generation;
+    int running;
+    bool stopping;
+
+    void workerLoop(int index) {
+        unsigned long long seen = 0;
+        while (true) {
+            const std::function<void(int)>* current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_ready.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                current = job;
+            }
+            (*current)(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--running == 0) job_done.notify_one();
+            }
+        }
+    }
+
+public:
+    // num_threads <= 0 uses every hardware thread
+    explicit ThreadPool(int num_threads = 0) : job(nullptr), generation(0), running(0), stopping(false) {
+        if (num_threads <= 0) {
+            num_threads = static_cast<int>(std::thread::hardware_concurrency());
+            if (num_threads <= 0) num_threads = 1;
+        }
+        for (int i = 1; i < num_threads; ++i) {
+            threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        job_ready.notify_all();
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+        }
+    }
+
+    int size() const {
+        return static_cast<int>(threads.size()) + 1;
+    }
+
+    // Calls job(worker_index) once on each worker, worker_index in [0, size())
+    void run(const std::function<void(int)>& work) {
+        if (!threads.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &work;
+            running = static_cast<int>(threads.size());
+            generation++;
+        }
+        job_ready.notify_all();
+        work(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        job_done.wait(lock, [&] { return running == 0; });
+    }
+};
+
+#endif
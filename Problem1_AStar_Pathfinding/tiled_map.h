@@ -0,0 +1,134 @@
+#ifndef TILED_MAP_H
+#define TILED_MAP_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include "grid_generator.h"
+#include "mapped_file.h"
+
+// Binary map format that is searched in place through a memory mapping.
+// Obstacle bits are cut into 64x64 tiles of 512 bytes, one 64-bit word
+// per tile row, and the tiles are stored row-major. A search reads only
+// the tiles around the cells it visits, so the OS pages in that part of
+// the file and nothing else.
+//
+// The solvers key cells as int (y * width + x), so a map holds at most
+// 2^31 - 1 cells, about 46340 x 46340 or 256 MiB of obstacle bits.
+// open() rejects larger files rather than let the keys overflow.
+//
+// File layout: a 64-byte TiledMapHeader, then tiles_x * tiles_y tiles.
+// Bits past the right and bottom edges are set (blocked).
+struct TiledMapHeader {
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    uint32_t tiles_x;
+    uint32_t tiles_y;
+    int32_t start_x, start_y;
+    int32_t goal_x, goal_y;
+    char reserved[24];
+};
+
+static const int TILE_EDGE = 64;
+static const char TILED_MAP_MAGIC[8] = {'G', 'R', 'I', 'D', 'T', 'I', 'L', '1'};
+
+bool saveTiledMap(const std::string& path, const Grid& grid) {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if (!out) return false;
+    TiledMapHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TILED_MAP_MAGIC, sizeof(header.magic));
+    header.width = grid.width;
+    header.height = grid.height;
+    header.tiles_x = (grid.width + TILE_EDGE - 1) / TILE_EDGE;
+    header.tiles_y = (grid.height + TILE_EDGE - 1) / TILE_EDGE;
+    header.start_x = grid.start.x;
+    header.start_y = grid.start.y;
+    header.goal_x = grid.goal.x;
+    header.goal_y = grid.goal.y;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t tile[TILE_EDGE];
+    for (uint32_t ty = 0; ty < header.tiles_y; ++ty) {
+        for (uint32_t tx = 0; tx < header.tiles_x; ++tx) {
+            for (int row = 0; row < TILE_EDGE; ++row) {
+                int y = ty * TILE_EDGE + row;
+                // rowBits() reads past-the-edge columns and the bottom border as blocked
+                tile[row] = y < grid.height ? grid.rowBits(y, tx * TILE_EDGE) : ~uint64_t(0);
+            }
+            out.write(reinterpret_cast<const char*>(tile), sizeof(tile));
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+// Read-only map over a tiled file, usable wherever the solvers take a map
+// type (BasicAStar's MapT). Cells outside the map read as blocked.
+class TiledMap {
+private:
+    MappedFile file;
+    const uint64_t* tiles;
+    uint32_t tiles_x;
+
+public:
+    Cell start;
+    Cell goal;
+    int width, height;
+
+    TiledMap() : tiles(nullptr), tiles_x(0), width(0), height(0) {
+        start.x = start.y = goal.x = goal.y = 0;
+    }
+
+    // Maps a file written by saveTiledMap(); false if it is malformed or
+    // has more cells than a cell key can index
+    bool open(const std::string& path) {
+        MappedFile mapped;
+        if (!mapped.open(path) || mapped.size() < sizeof(TiledMapHeader)) return false;
+        TiledMapHeader header;
+        std::memcpy(&header, mapped.data(), sizeof(header));
+        if (std::memcmp(header.magic, TILED_MAP_MAGIC, sizeof(header.magic)) != 0) return false;
+        if (header.tiles_x != (header.width + TILE_EDGE - 1) / TILE_EDGE ||
+            header.tiles_y != (header.height + TILE_EDGE - 1) / TILE_EDGE) {
+            return false;
+        }
+        if (header.width > static_cast<uint32_t>(INT32_MAX) || header.height > static_cast<uint32_t>(INT32_MAX) ||
+            static_cast<uint64_t>(header.width) * header.height > static_cast<uint64_t>(INT32_MAX)) {
+            return false;
+        }
+        size_t tile_bytes = static_cast<size_t>(TILE_EDGE) * sizeof(uint64_t);
+        if (mapped.size() != sizeof(header) + static_cast<size_t>(header.tiles_x) * header.tiles_y * tile_bytes) {
+            return false;
+        }
+
+        file.swap(mapped);
+        tiles = reinterpret_cast<const uint64_t*>(file.data() + sizeof(header));
+        tiles_x = header.tiles_x;
+        width = header.width;
+        height = header.height;
+        start.x = header.start_x;
+        start.y = header.start_y;
+        goal.x = header.goal_x;
+        goal.y = header.goal_y;
+        return true;
+    }
+
+    bool isValidCell(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+
+    bool isObstacle(int x, int y) const {
+        if (!isValidCell(x, y)) return true;
+        size_t tile = static_cast<size_t>(y / TILE_EDGE) * tiles_x + x / TILE_EDGE;
+        uint64_t row = tiles[tile * TILE_EDGE + y % TILE_EDGE];
+        return (row >> (x % TILE_EDGE)) & 1;
+    }
+
+    size_t fileBytes() const {
+        return file.size();
+    }
+};
+
+#endif